@@ -8,13 +8,10 @@ for n in $(seq 4 1 10); do
     # Probabilities here
     for p in 0.50; do
 
-      # Usage: <name_of_cnf> <prob> <num_seeds> [optional_seed]
-      python ../src/blocking_randomizer.py Pigeon${enc}B2N${n}.cnf $p 60
-
-      # Will output as Randomizer${i}.cnf -> conveniently rename and move
-      for i in $(seq 1 1 60); do
-        mv ./Randomizer${i}.cnf Pigeon${enc}B2N${n}P${p}Seed${i}.cnf
-      done
+      # Matchings are enumerated once; writes 60 replicas, each keeping a
+      #   random fraction p of the blocked clauses
+      # Outputs Pigeon${enc}B2N${n}P${p}Seed${i}.cnf for i in 1..60
+      ../bipartgen -g pigeon -e $enc -n $n -b 2 -P $p -K 60 -f Pigeon${enc}B2N${n}P${p}
 
     done
   done
@@ -19,6 +19,20 @@
 /** @file additionalgraphs.c
  *  @brief Instance generator for additional graphs.
  *
+ *  Besides uniform random graphs, three structured random families are
+ *  generated, each in time linear in the number of edges:
+ *
+ *    - Regular: every node on the larger side has degree d, paired with
+ *      the other side by a configuration model (a shuffled list of degree
+ *      "stubs"), whose degrees are then as equal as the sizes allow.
+ *    - Power law: a Chung-Lu graph, where node i on each side has weight
+ *      (i + 1)^(-1 / (exponent - 1)), and each edge picks its ends with
+ *      probability proportional to weight, through alias tables.
+ *    - Planted: a random matching covering the smaller side, plus noise
+ *      edges chosen uniformly at random.
+ *
+ *  Repeated edges are collapsed into one, so edge counts are targets.
+ *
  *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
  *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
  *
@@ -30,6 +44,8 @@
 #include "xmalloc.h"
 #include "stdio.h"
 #include "stdbool.h"
+#include "math.h"
+#include "rng.h"
 
 /** @brief Defines graph variables.
  *
@@ -37,6 +53,14 @@
  *  cardinality   Difference in # nodes between sides.
  *  density        Density of random graph.
  *  nedges        Edge count of random graph.
+ *  degree        Degree of regular graphs, and the average degree of the
+ *                  smaller side for power law and planted graphs when
+ *                  neither density nor nedges bound the edges.
+ *  exponent      Exponent of the power law degree distribution, above 2.
+ *  spanning      Structure of random graphs before their random edges.
+ *  pool          All possible edges, kept between random graphs, or NULL.
+ *  swaps         Swaps of the draws from pool, to undo them.
+ *  lefts/rights  Scratch for the edges of one row, or NULL.
  *
  */
 struct graph_variables {
@@ -44,6 +68,13 @@ struct graph_variables {
   int cardinality;
   float density;
   int nedges;
+  int degree;
+  double exponent;
+  spanning_t spanning;
+  struct edge_struct *pool;
+  int *swaps;
+  int *lefts;
+  int *rights;
 }; // graph_var_t
 
 /** @brief Creates the graph variables data structure with default values set in bipargen.c.
@@ -61,84 +92,319 @@ graph_var_t *graph_var_create(int n, int cardinality, float density, int nedges)
   gt->cardinality = cardinality;
   gt->density = density;
   gt->nedges = nedges;
+  gt->degree = 3;
+  gt->exponent = 2.5;
+  gt->spanning = SPAN_TREE;
+  gt->pool = NULL;
+  gt->swaps = NULL;
+  gt->lefts = NULL;
+  gt->rights = NULL;
   return gt;
 }
 
+/** @brief Frees the graph variables and their scratch space.
+ *
+ *  @param gv  Graph variables.
+ */
+void graph_var_free(graph_var_t *gv) {
+  xfree(gv->pool);
+  xfree(gv->swaps);
+  xfree(gv->lefts);
+  xfree(gv->rights);
+  xfree(gv);
+}
+
+/** @brief Sets the degree of regular graphs (and the default average
+ *         degree of power law and planted graphs).
+ *
+ *  @param gv      Graph variables.
+ *  @param degree  The degree, at least 1.
+ */
+void graph_var_set_degree(graph_var_t *gv, int degree) {
+  if (degree < 1) {
+    fprintf(stderr, "Degree must be at least 1\n");
+    exit(-1);
+  }
+  gv->degree = degree;
+}
+
+/** @brief Sets the exponent of power law degree distributions.
+ *
+ *  @param gv        Graph variables.
+ *  @param exponent  The exponent, above 2 so the average degree is finite.
+ */
+void graph_var_set_exponent(graph_var_t *gv, double exponent) {
+  if (exponent <= 2) {
+    fprintf(stderr, "Power law exponent must be above 2\n");
+    exit(-1);
+  }
+  gv->exponent = exponent;
+}
+
+/** @brief Sets the structure random graphs start from.
+ *
+ *  @param gv        Graph variables.
+ *  @param spanning  The structure.
+ */
+void graph_var_set_spanning(graph_var_t *gv, spanning_t spanning) {
+  gv->spanning = spanning;
+}
+
 struct edge_struct {
   int n1;
   int n2;
 };
 typedef struct edge_struct edge_t;
 
-/** @brief Shuffles elements of a list (of edges).
+/** @brief Shuffles the first k elements of a list (of edges).
+ *
+ *  Forward Fisher-Yates stopped after k steps: each of the first k slots
+ *  takes a uniformly random edge of the ones not yet drawn, so they hold
+ *  a uniform random k-subset in random order, and the rest of the list
+ *  is left unshuffled. With k = edgeCount the whole list is shuffled.
  *
- *  @param edges           list of edges to be shuffled.
+ *  @param edges      list of edges to be shuffled.
  *  @param edgeCount  Number of edges in list.
+ *  @param k          Number of edges to draw.
+ *  @param r          Random number generator.
+ *  @param swaps      If not NULL, records at i the offset p - i of the edge
+ *                    swapped into slot i, so the shuffle can be undone.
  */
-void shuffle_edges(edge_t *edges, int edgeCount) {
+static void shuffle_edges(edge_t *edges, int edgeCount, int k, rng_t *r, int *swaps) {
   edge_t temp;
   int p;
-  for(int i = edgeCount-1; i > 0; i--) {
-        p = rand()%i;
+  if (k > edgeCount) k = edgeCount;
+  for(int i = 0; i < k; i++) {
+        // The last edge has nowhere else to go, but its swap is recorded
+        p = (i == edgeCount - 1) ? i : i + rng_bounded(r, edgeCount - i);
         temp = edges[p];
         edges[p] = edges[i];
         edges[i] = temp;
+        if (swaps != NULL) swaps[i] = p - i;
+  }
+}
+
+/** @brief Adds each missing edge of a row with probability q.
+ *
+ *  Sparse rows skip geometrically distributed gaps between edges, and
+ *  dense rows skip the same way between non-edges, so a row costs time
+ *  proportional to the smaller of the two counts.
+ *
+ *  @param g        The graph.
+ *  @param n1       The node of partition 0.
+ *  @param size     The size of partition 1.
+ *  @param q        The probability of each edge.
+ *  @param r        The random number generator.
+ *  @param lefts    Scratch for size nodes of partition 0.
+ *  @param rights   Scratch for size nodes of partition 1.
+ */
+static void fill_random_row(graph_t *g, int n1, int size, double q, rng_t *r,
+    int *lefts, int *rights) {
+  int count = 0;
+  if (q >= 1.0) {
+    for (int j = 0; j < size; j++) rights[count++] = j;
+  } else if (q > 0.5) {
+    // Skip from one non-edge to the next, adding the edges in between
+    const double log_miss = log(q);
+    int j = 0;
+    while (true) {
+      const int next = j + (int) fmin(log(1.0 - rng_double(r)) / log_miss, size);
+      for (; j < next && j < size; j++) rights[count++] = j;
+      if (j >= size) break;
+      j++;
+    }
+  } else if (q > 0.0) {
+    // Skip from one edge to the next
+    const double log_miss = log(1.0 - q);
+    double j = fmin(log(1.0 - rng_double(r)) / log_miss, size);
+    while (j < size) {
+      rights[count++] = (int) j;
+      j = fmin(floor(j) + 1 + log(1.0 - rng_double(r)) / log_miss, size);
+    }
   }
+
+  for (int k = 0; k < count; k++) lefts[k] = n1;
+  graph_add_edges(g, 0, 1, lefts, rights, count);
+}
+
+/** @brief Adds a random spanning tree by Wilson's algorithm.
+ *
+ *  Loop-erased random walks on the complete bipartite graph, from each
+ *  node not yet in the tree until they hit it, give a spanning tree drawn
+ *  uniformly from all spanning trees. A walk alternates sides, each step
+ *  to a uniform node of the other side, so it hits the tree in O(1)
+ *  expected steps once the tree holds a constant fraction of either side,
+ *  and the whole tree takes near-linear time.
+ *
+ *  @param g  The graph, with nodes 0..sizes[0]-1 of partition 0 numbered
+ *            as is and nodes of partition 1 after them.
+ *  @param r  The random number generator.
+ *  @return   The number of edges added.
+ */
+static int add_uniform_spanning_tree(graph_t *g, rng_t *r) {
+  const int *sizes = graph_get_partition_sizes(g);
+  const int total = sizes[0] + sizes[1];
+  bool *in_tree = xcalloc(total + 1, sizeof(bool));
+  int *next = xmalloc((total + 1) * sizeof(int));
+  int edges = 0;
+
+  // Root at the first node of partition 1
+  in_tree[sizes[0]] = true;
+  for (int start = 0; start < total; start++) {
+    // Walk, keeping only the last exit from each node, which erases loops
+    int u = start;
+    while (!in_tree[u]) {
+      next[u] = (u < sizes[0]) ? sizes[0] + rng_bounded(r, sizes[1])
+                               : rng_bounded(r, sizes[0]);
+      u = next[u];
+    }
+    for (u = start; !in_tree[u]; u = next[u]) {
+      in_tree[u] = true;
+      if (u < sizes[0]) graph_add_edge(g, 0, u, 1, next[u] - sizes[0]);
+      else graph_add_edge(g, 0, next[u], 1, u - sizes[0]);
+      edges++;
+    }
+  }
+
+  xfree(in_tree);
+  xfree(next);
+  return edges;
+}
+
+/** @brief Adds the spanning structure of a random graph.
+ *
+ *  @param g          The graph, with no edges.
+ *  @param spanning   The structure, see spanning_t.
+ *  @param r          The random number generator.
+ *  @return           The number of edges added.
+ */
+static int add_spanning_structure(graph_t *g, spanning_t spanning, rng_t *r) {
+  const int *sizes = graph_get_partition_sizes(g);
+  int edges = 0, n2;
+  switch (spanning) {
+    case SPAN_NONE:
+      break;
+    case SPAN_TREE:
+      // Node i to node i and to a random earlier node of partition 1
+      for(int i = 0; i < sizes[0]; i++) {
+        if (i < sizes[1]) { // edge across
+          edges++;
+          graph_add_edge(g,0,i,1,i);
+          if (i > 0) n2 = rng_bounded(r, i);
+          else n2 = 0;
+        }
+        else n2 = rng_bounded(r, sizes[1]);
+        // edge to random node 0 <= n2 < i
+        graph_add_edge(g,0,i,1,n2);
+        if (i>0) edges++;
+      }
+      break;
+    case SPAN_UST:
+      edges = add_uniform_spanning_tree(g, r);
+      break;
+    case SPAN_MATCHING: {
+      // Random injection of the smaller side into the larger one
+      const int small = (sizes[0] < sizes[1]) ? 0 : 1;
+      int *perm = xmalloc((sizes[1 - small] + 1) * sizeof(int));
+      for (int i = 0; i < sizes[1 - small]; i++) {
+        perm[i] = i;
+      }
+      for (int i = 0; i < sizes[small]; i++) {
+        const int j = i + rng_bounded(r, sizes[1 - small] - i);
+        const int tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+        if (small == 0) graph_add_edge(g, 0, i, 1, perm[i]);
+        else graph_add_edge(g, 0, perm[i], 1, i);
+        edges++;
+      }
+      xfree(perm);
+      break;
+    }
+  }
+  return edges;
 }
 
 /** @brief Generate a graph based on graph_variable parameters.
+ *
+ *  A spanning structure connects the nodes first. With an edge count,
+ *  shuffled edges are then added until the count is reached; with a
+ *  density, each other edge is added independently so the expected edge
+ *  count is density times the possible edges.
  *
  *  @param gv  Graph variables used to generate graph.
  *  @param seed Random number seed.
  *  @return   A bi-partite graph with edges based on graph variable values.
  */
 graph_t *generate_random_graph(graph_var_t *gv, int seed) {
-  graph_t* g;
+  int sizes[2] = {gv->n+gv->cardinality, gv->n};
+  graph_t *g = graph_create_with_sizes(2, sizes);
+  generate_random_graph_into(gv, seed, g);
+  return g;
+}
+
+/** @brief Generate a random graph into an existing graph of the same sizes.
+ *
+ *  Clears the graph and fills it as generate_random_graph() would for the
+ *  seed. The pool of possible edges and other scratch space are kept in
+ *  the graph variables, so a range of seeds allocates them once.
+ *
+ *  @param gv   Graph variables used to generate graph.
+ *  @param seed Random number seed.
+ *  @param g    A bi-partite graph of the sizes given by gv.
+ */
+void generate_random_graph_into(graph_var_t *gv, int seed, graph_t *g) {
   int sizes[2] = {gv->n+gv->cardinality, gv->n}, edgeLimit;
-  int i, r, edgeShuffSize, edgeN = 0;
+  int i, r, edgeShuffSize = sizes[0] * sizes[1], edgeN;
   float density = gv->density;
   edge_t edge;
-  edge_t edgeShuff[sizes[0]*sizes[1]];
   bool byCount = false;
   if (gv->nedges > 0) byCount = true;
   
-  // fill edgeShuff with all possible edges
-  r = 0;
-  for(int i = 0; i < sizes[0]; i++) {
-    for(int j = 0; j < sizes[1]; j++) {
-      edgeShuff[r].n1 = i;
-      edgeShuff[r].n2 = j;
-      r++;
+  if (byCount && gv->pool == NULL) {
+    // fill edgeShuff with all possible edges, once
+    gv->pool = xmalloc(((long long) edgeShuffSize + 1) * sizeof(edge_t));
+    gv->swaps = xmalloc(((long long) edgeShuffSize + 1) * sizeof(int));
+    r = 0;
+    for(int i = 0; i < sizes[0]; i++) {
+      for(int j = 0; j < sizes[1]; j++) {
+        gv->pool[r].n1 = i;
+        gv->pool[r].n2 = j;
+        r++;
+      }
     }
   }
-  edgeShuffSize = r;
+  edge_t *edgeShuff = gv->pool;
   // seed random number generator
-  srand(seed);
+  rng_t rng;
+  rng_seed(&rng, seed);
   
-  // create graph
-  g = graph_create_with_sizes(2, sizes);
+  // empty the graph
+  graph_clear(g);
   
   edgeLimit = density * (sizes[0] * sizes[1]);
 
-  // Build random spanning tree
-  for(int i = 0; i < sizes[0]; i++) {
-    if (i < sizes[1]) { // edge across
-      edgeLimit--;
-      edgeN++;
-      graph_add_edge(g,0,i,1,i);
-      if (i > 0) r = rand()%i;
-      else r = 0;
+  // Build the spanning structure
+  edgeN = add_spanning_structure(g, gv->spanning, &rng);
+  edgeLimit -= edgeN;
+  
+  if (!byCount) {
+    // Each remaining pair gets the share of the edge limit left over by
+    //   the spanning tree
+    const long long pairs = (long long) sizes[0] * sizes[1] - edgeN;
+    const double q = (pairs > 0) ? (double) edgeLimit / pairs : 0.0;
+    if (gv->lefts == NULL) {
+      gv->lefts = xmalloc((sizes[1] + 1) * sizeof(int));
+      gv->rights = xmalloc((sizes[1] + 1) * sizeof(int));
     }
-    else r = rand() % sizes[1];
-    // edge to random node 0 <= r < i
-    graph_add_edge(g,0,i,1,r);
-    if (i>0) {edgeLimit--; edgeN++;}
+    for(int i = 0; i < sizes[0]; i++) {
+      fill_random_row(g, i, sizes[1], (density >= 1.0) ? 1.0 : q, &rng, gv->lefts, gv->rights);
+    }
+    return;
   }
   
-  // Randomly shuffly possible edges
-  shuffle_edges(edgeShuff, edgeShuffSize);
-  
-  // Add edges randomly until edgeLimit is reached
+  // Add edges randomly until edgeLimit is reached, drawing each from the
+  //   possible edges left only when it is needed
   i = 0;
   
   while (true) {
@@ -146,8 +412,8 @@ graph_t *generate_random_graph(graph_var_t *gv, int seed) {
       printf("Number of edges too high for given size with density 1.\n");
       break;
     }
-    if (!byCount && (edgeLimit <= 0)) break; // based on density
-    else if (byCount && (edgeN >= gv->nedges)) break; // based on edge_count
+    if (edgeN >= gv->nedges) break; // based on edge_count
+    shuffle_edges(edgeShuff + i, edgeShuffSize - i, 1, &rng, gv->swaps + i);
     edge = edgeShuff[i++];
     if (!graph_is_edge_between(g, 0, edge.n1, 1, edge.n2)) {
       graph_add_edge(g, 0, edge.n1, 1, edge.n2);
@@ -157,5 +423,269 @@ graph_t *generate_random_graph(graph_var_t *gv, int seed) {
     
   }
   
+  // Undo the draws, so the next seed starts from the same pool
+  while (i-- > 0) {
+    edge = edgeShuff[i];
+    edgeShuff[i] = edgeShuff[i + gv->swaps[i]];
+    edgeShuff[i + gv->swaps[i]] = edge;
+  }
+}
+
+/********** Structured random graphs ************/
+
+/** @brief Edges collected by a generator, added to the graph in one batch.
+ *
+ *  lefts:   Nodes of the edges in partition 0.
+ *  rights:  Nodes of the edges in partition 1.
+ *  size:    The number of edges.
+ */
+typedef struct edge_list {
+  int *lefts;
+  int *rights;
+  int size;
+} edge_list_t;
+
+/** @brief Alias table for constant time sampling from a distribution.
+ *
+ *  Node i is drawn by picking a column i uniformly, then keeping it with
+ *  probability prob[i], and otherwise taking alias[i] (Vose's method).
+ */
+typedef struct alias_table {
+  double *prob;
+  int *alias;
+  int n;
+} alias_t;
+
+/** @brief Allocates an edge list for up to cap edges. */
+static void edge_list_init(edge_list_t *l, long long cap) {
+  l->lefts = xmalloc((cap + 1) * sizeof(int));
+  l->rights = xmalloc((cap + 1) * sizeof(int));
+  l->size = 0;
+}
+
+/** @brief Adds the edges of a list to a graph, and frees the list. */
+static void edge_list_flush(edge_list_t *l, graph_t *g) {
+  graph_add_edges(g, 0, 1, l->lefts, l->rights, l->size);
+  xfree(l->lefts);
+  xfree(l->rights);
+}
+
+/** @brief Returns the number of edges a generator aims for.
+ *
+ *  nedges if given, else density times the possible edges if below 1,
+ *  else degree times the size of the smaller side.
+ */
+static long long target_edges(graph_var_t *gv, const int *sizes) {
+  if (gv->nedges > 0) {
+    return gv->nedges;
+  } else if (gv->density < 1.0) {
+    return (long long) (gv->density * ((long long) sizes[0] * sizes[1]));
+  }
+  return (long long) gv->degree * sizes[1];
+}
+
+/** @brief Builds an alias table for weights proportional to w.
+ *
+ *  @param a  A pointer to the table.
+ *  @param w  The weights, all positive.
+ *  @param n  The number of weights.
+ */
+static void alias_init(alias_t *a, const double *w, int n) {
+  a->n = n;
+  a->prob = xmalloc(n * sizeof(double));
+  a->alias = xmalloc(n * sizeof(int));
+  int *small = xmalloc(n * sizeof(int));
+  int *large = xmalloc(n * sizeof(int));
+  int num_small = 0, num_large = 0;
+
+  double total = 0;
+  for (int i = 0; i < n; i++) {
+    total += w[i];
+  }
+  for (int i = 0; i < n; i++) {
+    a->prob[i] = w[i] * n / total;
+    a->alias[i] = i;
+    if (a->prob[i] < 1.0) small[num_small++] = i;
+    else large[num_large++] = i;
+  }
+
+  // Fill each short column from a tall one
+  while (num_small > 0 && num_large > 0) {
+    const int s = small[--num_small], l = large[num_large - 1];
+    a->alias[s] = l;
+    a->prob[l] -= 1.0 - a->prob[s];
+    if (a->prob[l] < 1.0) {
+      num_large--;
+      small[num_small++] = l;
+    }
+  }
+  while (num_large > 0) a->prob[large[--num_large]] = 1.0;
+  while (num_small > 0) a->prob[small[--num_small]] = 1.0;
+
+  xfree(small);
+  xfree(large);
+}
+
+/** @brief Draws a node from an alias table. */
+static inline int alias_sample(alias_t *a, rng_t *r) {
+  const int i = rng_bounded(r, a->n);
+  return (rng_double(r) < a->prob[i]) ? i : a->alias[i];
+}
+
+/** @brief Frees the arrays of an alias table. */
+static void alias_free(alias_t *a) {
+  xfree(a->prob);
+  xfree(a->alias);
+}
+
+
+/** @brief Generate a regular bipartite graph by a configuration model.
+ *
+ *  Each node of the larger side (partition 0) gets degree stubs, and the
+ *  stubs of the smaller side are spread as evenly as possible, so with
+ *  no cardinality difference the graph is degree-regular. The stubs of
+ *  partition 1 are shuffled and dealt to the stubs of partition 0 in
+ *  order. A stub that would repeat an edge of its node is swapped with a
+ *  random later stub, which keeps every degree; after a few failed tries
+ *  the repeat is dropped.
+ *
+ *  @param gv   Graph variables used to generate graph.
+ *  @param seed Random number seed.
+ *  @return     A bipartite graph with the given degree.
+ */
+graph_t *generate_regular_graph(graph_var_t *gv, int seed) {
+  int sizes[2] = { gv->n + gv->cardinality, gv->n };
+  const int d = gv->degree;
+  if (d > sizes[1]) {
+    fprintf(stderr, "Degree %d is more than the %d nodes of the smaller side\n", d, sizes[1]);
+    exit(-1);
+  }
+
+  rng_t r;
+  rng_seed(&r, seed);
+  graph_t *g = graph_create_with_sizes(2, sizes);
+
+  const long long num_stubs = (long long) sizes[0] * d;
+  int *stubs = xmalloc((num_stubs + 1) * sizeof(int));
+  for (long long k = 0; k < num_stubs; k++) {
+    stubs[k] = (int) (k % sizes[1]);
+  }
+  rng_shuffle(&r, stubs, (int) num_stubs);
+
+  // Stamps mark the neighbors of the current node of partition 0
+  int *stamp = xmalloc(sizes[1] * sizeof(int));
+  for (int j = 0; j < sizes[1]; j++) stamp[j] = -1;
+
+  edge_list_t edges;
+  edge_list_init(&edges, num_stubs);
+  for (long long k = 0; k < num_stubs; k++) {
+    const int i = (int) (k / d);
+    const long long later = num_stubs - k - 1;
+    for (int tries = 0; stamp[stubs[k]] == i && tries < 16 && later > 0; tries++) {
+      const long long p = k + 1 + (long long) (rng_double(&r) * later);
+      const int tmp = stubs[k];
+      stubs[k] = stubs[p];
+      stubs[p] = tmp;
+    }
+    if (stamp[stubs[k]] == i) {
+      continue;
+    }
+
+    stamp[stubs[k]] = i;
+    edges.lefts[edges.size] = i;
+    edges.rights[edges.size++] = stubs[k];
+  }
+  edge_list_flush(&edges, g);
+
+  xfree(stubs);
+  xfree(stamp);
+  return g;
+}
+
+
+/** @brief Generate a bipartite Chung-Lu graph with power law degrees.
+ *
+ *  Node i of either side has weight (i + 1)^(-1 / (exponent - 1)), so the
+ *  expected degrees follow a power law with the given exponent, and the
+ *  lowest numbered nodes are the hubs. Each of the target edges draws its
+ *  two ends independently by weight.
+ *
+ *  @param gv   Graph variables used to generate graph.
+ *  @param seed Random number seed.
+ *  @return     A bipartite graph with power law degrees.
+ */
+graph_t *generate_power_law_graph(graph_var_t *gv, int seed) {
+  int sizes[2] = { gv->n + gv->cardinality, gv->n };
+  const long long m = target_edges(gv, sizes);
+  const double alpha = -1.0 / (gv->exponent - 1.0);
+
+  rng_t r;
+  rng_seed(&r, seed);
+  graph_t *g = graph_create_with_sizes(2, sizes);
+
+  alias_t sides[2];
+  double *w = xmalloc(((sizes[0] > sizes[1]) ? sizes[0] : sizes[1]) *
+      sizeof(double));
+  for (int p = 0; p < 2; p++) {
+    for (int i = 0; i < sizes[p]; i++) {
+      w[i] = pow(i + 1, alpha);
+    }
+    alias_init(&sides[p], w, sizes[p]);
+  }
+  xfree(w);
+
+  edge_list_t edges;
+  edge_list_init(&edges, m);
+  for (long long k = 0; k < m; k++) {
+    edges.lefts[edges.size] = alias_sample(&sides[0], &r);
+    edges.rights[edges.size++] = alias_sample(&sides[1], &r);
+  }
+  edge_list_flush(&edges, g);
+
+  alias_free(&sides[0]);
+  alias_free(&sides[1]);
+  return g;
+}
+
+
+/** @brief Generate a graph with a planted matching plus random noise.
+ *
+ *  The smaller side (partition 1 unless the cardinality is negative) is
+ *  matched to a random subset of the larger side, so the matching is
+ *  perfect up to the cardinality difference. The remaining target edges are chosen uniformly.
+ *
+ *  @param gv   Graph variables used to generate graph.
+ *  @param seed Random number seed.
+ *  @return     A bipartite graph containing a planted matching.
+ */
+graph_t *generate_planted_graph(graph_var_t *gv, int seed) {
+  int sizes[2] = { gv->n + gv->cardinality, gv->n };
+  const int small = (sizes[0] < sizes[1]) ? 0 : 1;
+  long long m = target_edges(gv, sizes);
+  if (m < sizes[small]) m = sizes[small];
+
+  rng_t r;
+  rng_seed(&r, seed);
+  graph_t *g = graph_create_with_sizes(2, sizes);
+
+  int *perm = xmalloc((sizes[1 - small] + 1) * sizeof(int));
+  for (int i = 0; i < sizes[1 - small]; i++) {
+    perm[i] = i;
+  }
+  rng_shuffle(&r, perm, sizes[1 - small]);
+
+  edge_list_t edges;
+  edge_list_init(&edges, m);
+  for (int j = 0; j < sizes[small]; j++) {
+    edges.lefts[edges.size] = (small == 1) ? perm[j] : j;
+    edges.rights[edges.size++] = (small == 1) ? j : perm[j];
+  }
+  while (edges.size < m) {
+    edges.lefts[edges.size] = rng_bounded(&r, sizes[0]);
+    edges.rights[edges.size++] = rng_bounded(&r, sizes[1]);
+  }
+  edge_list_flush(&edges, g);
+
+  xfree(perm);
   return g;
 }
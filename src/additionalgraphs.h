@@ -38,12 +38,37 @@
  */
 typedef struct graph_variables graph_var_t;
 
+/** @brief Structure added to a random graph before its random edges.
+ *
+ *  SPAN_TREE:      Node i of partition 0 joined to node i of partition 1
+ *                  and to a random earlier node of it; a spanning tree, but
+ *                  not a uniform one.
+ *
+ *  SPAN_NONE:      No structure, only random edges.
+ *
+ *  SPAN_UST:       A uniform random spanning tree (Wilson's algorithm).
+ *
+ *  SPAN_MATCHING:  A random matching covering the smaller partition, a
+ *                  perfect matching if the sizes are equal.
+ */
+typedef enum spanning_structure {
+  SPAN_TREE, SPAN_NONE, SPAN_UST, SPAN_MATCHING
+} spanning_t;
+
 /** Graph Generator API*/
 
 /* Creation Function*/
 graph_var_t *graph_var_create(int n, int card, float density, int nedges);
+void graph_var_free(graph_var_t *gv);
+void graph_var_set_degree(graph_var_t *gv, int degree);
+void graph_var_set_exponent(graph_var_t *gv, double exponent);
+void graph_var_set_spanning(graph_var_t *gv, spanning_t spanning);
 
 /* Generators */
 graph_t *generate_random_graph(graph_var_t *gv, int seed);
+void generate_random_graph_into(graph_var_t *gv, int seed, graph_t *g);
+graph_t *generate_regular_graph(graph_var_t *gv, int seed);
+graph_t *generate_power_law_graph(graph_var_t *gv, int seed);
+graph_t *generate_planted_graph(graph_var_t *gv, int seed);
 
 #endif /* _ADDITIONALGRAPHS_H */
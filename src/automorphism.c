@@ -0,0 +1,550 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+
+/** @file automorphism.c
+ *  @brief Generators of the automorphism group of a k-partite graph.
+ *
+ *  The automorphisms are the permutations of the nodes of each partition
+ *  that map edges to edges. They are found by individualization and
+ *  refinement, in the manner of nauty and saucy. Nodes are colored by
+ *  partition, and the coloring is refined until every node in a color
+ *  has the same number of neighbors of each color. Then a node of the
+ *  first color with several nodes is given a color of its own, and the
+ *  coloring is refined again, until every node has its own color. This
+ *  is the first path.
+ *
+ *  Going back up the first path, each other node w of the color of the
+ *  node v individualized at a level is individualized in its place, and
+ *  the search descends trying every node of the target color at each
+ *  deeper level, until the coloring is discrete. The node with each
+ *  color on the first path mapping to the node with that color gives a
+ *  candidate, which is checked against the edges. The first automorphism
+ *  found is a generator mapping v to w and fixing the nodes above it on
+ *  the first path. Nodes already in the orbit of v under the generators
+ *  found are skipped, so the generators at each level extend those below
+ *  it to the stabilizer of the nodes above it, and the group order is the
+ *  product of the orbit sizes.
+ *
+ *  Refinement compares colorings through a hash of the colors, neighbor
+ *  counts and class sizes of every round, which is the same for both
+ *  sides when the colorings correspond. A collision can only lead to a
+ *  candidate that fails the edge check, never to a wrong generator.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "automorphism.h"
+#include "xmalloc.h"
+
+/** @brief Defines a set of generators of the automorphisms of a graph.
+ *
+ *  partitions:      The number of partitions of the graph.
+ *  offsets:         The first global node number of each partition, and
+ *                   the number of nodes last. Node n of partition p is
+ *                   node offsets[p] + n.
+ *  generators:      Each maps every global node number to its image.
+ *  num_generators:  The number of generators.
+ *  cap:             The capacity of generators.
+ *  log_order:       The base 10 logarithm of the order of the group.
+ *  complete:        Whether the search finished within its limit. If not,
+ *                   the generators span a subgroup.
+ */
+struct automorphism_group {
+  int partitions;
+  int *offsets;
+  int **generators;
+  int num_generators;
+  int cap;
+  double log_order;
+  bool complete;
+};
+
+
+/** @brief A node by color and the hash of its neighbors' colors. */
+typedef struct node_key {
+  int color;
+  int node;
+  uint64_t sig;
+} node_key_t;
+
+
+/** @brief State of the search.
+ *
+ *  n:           The number of nodes.
+ *  adj_start:   Node v has neighbors adj[adj_start[v]] up to adj_start[v + 1].
+ *  part, index: The partition and node number of each node.
+ *  keys:        Scratch for refinement.
+ *  left:        The colorings of the first path by level, n each.
+ *  colors:      The number of colors of the first path by level.
+ *  path:        The node individualized at each level of the first path.
+ *  targets:     The color of that node before it was individualized.
+ *  traces:      The hash of refining the first path into each level.
+ *  depth:       The number of levels below the first.
+ *  right:       Colorings of the other paths by level, n each.
+ *  orbits:      Union-find over the orbits of the generators found.
+ *  map:         Scratch for a candidate automorphism.
+ */
+typedef struct search {
+  graph_t *g;
+  automorphism_t *a;
+  int n;
+  int *adj_start;
+  int *adj;
+  int *part;
+  int *index;
+  node_key_t *keys;
+  int *left;
+  int *colors;
+  int *path;
+  int *targets;
+  uint64_t *traces;
+  int depth;
+  int *right;
+  int *orbits;
+  int *map;
+  long refinements;
+  long limit;
+} search_t;
+
+
+/** @brief Mixes the bits of x (the splitmix64 finalizer). */
+static inline uint64_t mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+
+static int compare_keys(const void *a, const void *b) {
+  const node_key_t *x = a, *y = b;
+  if (x->color != y->color) return (x->color < y->color) ? -1 : 1;
+  if (x->sig != y->sig) return (x->sig < y->sig) ? -1 : 1;
+  return x->node - y->node;
+}
+
+
+/** @brief Refines a coloring until it is equitable.
+ *
+ *  Each round splits every color by the multiset of its nodes' neighbor
+ *  colors, numbering the new colors in order of the old color, then of
+ *  the multiset hash, so that corresponding colorings stay corresponding.
+ *
+ *  @param colors      The color of each node, from 0 to num_colors - 1.
+ *  @param num_colors  The number of colors.
+ *  @param trace[out]  A hash of the rounds, equal for corresponding colorings.
+ *  @return            The number of colors after refinement.
+ */
+static int refine(search_t *s, int *colors, int num_colors, uint64_t *trace) {
+  const int n = s->n;
+  uint64_t t = 0;
+  while (true) {
+    s->refinements++;
+    for (int v = 0; v < n; v++) {
+      uint64_t sig = 0;
+      for (int e = s->adj_start[v]; e < s->adj_start[v + 1]; e++) {
+        sig += mix(colors[s->adj[e]] + 1);
+      }
+      s->keys[v].color = colors[v];
+      s->keys[v].node = v;
+      s->keys[v].sig = sig;
+    }
+    qsort(s->keys, n, sizeof(node_key_t), compare_keys);
+
+    int next = 0;
+    int run = 0;
+    for (int i = 0; i < n; i++) {
+      if (i > 0 && (s->keys[i].color != s->keys[i - 1].color ||
+                    s->keys[i].sig != s->keys[i - 1].sig)) {
+        t = mix(t + s->keys[i - 1].sig + mix(s->keys[i - 1].color) + run);
+        next++;
+        run = 0;
+      }
+      colors[s->keys[i].node] = next;
+      run++;
+    }
+    t = mix(t + s->keys[n - 1].sig + mix(s->keys[n - 1].color) + run);
+    next++;
+
+    // Colors only split, so the same number means nothing changed
+    if (next == num_colors) {
+      break;
+    }
+    num_colors = next;
+  }
+
+  *trace = t;
+  return num_colors;
+}
+
+
+/** @brief Finds the lowest color with more than one node, or -1. */
+static int find_target(search_t *s, const int *colors, int num_colors) {
+  int *counts = s->map;
+  memset(counts, 0, num_colors * sizeof(int));
+  for (int v = 0; v < s->n; v++) {
+    counts[colors[v]]++;
+  }
+  for (int c = 0; c < num_colors; c++) {
+    if (counts[c] > 1) {
+      return c;
+    }
+  }
+  return -1;
+}
+
+
+static int find_orbit(int *orbits, int v) {
+  while (orbits[v] != v) {
+    orbits[v] = orbits[orbits[v]];
+    v = orbits[v];
+  }
+  return v;
+}
+
+
+/** @brief Checks the candidate given by two discrete colorings, and
+ *         records it as a generator if it is an automorphism.
+ */
+static bool check_candidate(search_t *s, const int *left, const int *right) {
+  const int n = s->n;
+  int *by_color = s->map + n;
+  for (int v = 0; v < n; v++) {
+    by_color[right[v]] = v;
+  }
+  for (int v = 0; v < n; v++) {
+    s->map[v] = by_color[left[v]];
+  }
+
+  // Colors start as partitions, so the map keeps each node in its own
+  for (int v = 0; v < n; v++) {
+    const int w = s->map[v];
+    for (int e = s->adj_start[v]; e < s->adj_start[v + 1]; e++) {
+      const int u = s->adj[e];
+      const int x = s->map[u];
+      if (s->part[u] > s->part[v] &&
+          !graph_is_edge_between(s->g, s->part[w], s->index[w],
+                                 s->part[x], s->index[x])) {
+        return false;
+      }
+    }
+  }
+
+  automorphism_t *a = s->a;
+  if (a->num_generators == a->cap) {
+    a->cap = (a->cap == 0) ? 16 : 2 * a->cap;
+    a->generators = xrealloc(a->generators, a->cap * sizeof(int *));
+  }
+  int *gen = xmalloc(n * sizeof(int));
+  memcpy(gen, s->map, n * sizeof(int));
+  a->generators[a->num_generators++] = gen;
+
+  for (int v = 0; v < n; v++) {
+    const int x = find_orbit(s->orbits, v);
+    const int y = find_orbit(s->orbits, gen[v]);
+    if (x != y) {
+      s->orbits[x] = y;
+    }
+  }
+  return true;
+}
+
+
+static bool search_level(search_t *s, int level, const int *right,
+    int num_colors);
+
+/** @brief Individualizes w in the coloring right at level, and searches
+ *         below it for an automorphism.
+ */
+static bool try_image(search_t *s, int level, const int *right,
+    int num_colors, int w) {
+  if (s->refinements >= s->limit) {
+    s->a->complete = false;
+    return false;
+  }
+
+  const int n = s->n;
+  int *next = s->right + (level + 1) * n;
+  memcpy(next, right, n * sizeof(int));
+  next[w] = num_colors;
+
+  uint64_t trace;
+  const int next_colors = refine(s, next, num_colors + 1, &trace);
+  if (next_colors != s->colors[level + 1] || trace != s->traces[level]) {
+    return false;
+  }
+  return search_level(s, level + 1, next, next_colors);
+}
+
+
+/** @brief Searches for an automorphism mapping the first path at level,
+ *         and the coloring right, which corresponds to it.
+ */
+static bool search_level(search_t *s, int level, const int *right,
+    int num_colors) {
+  const int *left = s->left + level * s->n;
+  if (level == s->depth) {
+    return check_candidate(s, left, right);
+  }
+
+  const int target = s->targets[level];
+  for (int w = 0; w < s->n && s->a->complete; w++) {
+    if (right[w] == target && try_image(s, level, right, num_colors, w)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/** @brief Builds the adjacency lists of the graph over global node numbers. */
+static void fill_adjacency(search_t *s) {
+  graph_t *g = s->g;
+  const int *offsets = s->a->offsets;
+  const int partitions = s->a->partitions;
+  const int n = s->n;
+
+  s->adj_start = xcalloc(n + 1, sizeof(int));
+  for (int p = 0; p < partitions; p++) {
+    for (int v = offsets[p]; v < offsets[p + 1]; v++) {
+      s->part[v] = p;
+      s->index[v] = v - offsets[p];
+      for (int q = 0; q < partitions; q++) {
+        if (q != p) {
+          s->adj_start[v + 1] += graph_get_num_neighbors(g, p, v - offsets[p], q);
+        }
+      }
+    }
+  }
+  for (int v = 0; v < n; v++) {
+    s->adj_start[v + 1] += s->adj_start[v];
+  }
+
+  s->adj = xmalloc((s->adj_start[n] + 1) * sizeof(int));
+  for (int v = 0; v < n; v++) {
+    int e = s->adj_start[v];
+    for (int q = 0; q < partitions; q++) {
+      if (q == s->part[v]) {
+        continue;
+      }
+      for (int u = graph_get_next_neighbor(g, s->part[v], s->index[v], q, 0);
+          u >= 0; u = graph_get_next_neighbor(g, s->part[v], s->index[v], q, u + 1)) {
+        s->adj[e++] = offsets[q] + u;
+      }
+    }
+  }
+}
+
+
+/** @brief Finds generators of the automorphism group of a graph.
+ *
+ *  The automorphisms map each partition to itself. The generators are
+ *  ordered from the top of the first path down, so the first ones move
+ *  the lowest numbered nodes.
+ *
+ *  @param g             A pointer to a graph.
+ *  @param search_limit  The number of refinement rounds after which the
+ *                       search stops, keeping the generators found.
+ *  @return              A pointer to the generators found.
+ */
+automorphism_t *automorphism_find(graph_t *g, long search_limit) {
+  automorphism_t *a = xmalloc(sizeof(automorphism_t));
+  a->partitions = graph_get_num_partitions(g);
+  a->offsets = xmalloc((a->partitions + 1) * sizeof(int));
+  a->offsets[0] = 0;
+  const int *sizes = graph_get_partition_sizes(g);
+  for (int p = 0; p < a->partitions; p++) {
+    a->offsets[p + 1] = a->offsets[p] + sizes[p];
+  }
+  a->generators = NULL;
+  a->num_generators = 0;
+  a->cap = 0;
+  a->log_order = 0.0;
+  a->complete = true;
+
+  search_t s;
+  s.g = g;
+  s.a = a;
+  s.n = a->offsets[a->partitions];
+  s.refinements = 0;
+  s.limit = search_limit;
+  const int n = s.n;
+  s.part = xmalloc(n * sizeof(int));
+  s.index = xmalloc(n * sizeof(int));
+  s.keys = xmalloc(n * sizeof(node_key_t));
+  s.map = xmalloc(2 * n * sizeof(int));
+  s.orbits = xmalloc(n * sizeof(int));
+  fill_adjacency(&s);
+
+  // The first path, grown a level at a time
+  int cap = 4;
+  s.left = xmalloc(cap * n * sizeof(int));
+  s.colors = xmalloc(cap * sizeof(int));
+  s.path = xmalloc(cap * sizeof(int));
+  s.targets = xmalloc(cap * sizeof(int));
+  s.traces = xmalloc(cap * sizeof(uint64_t));
+  for (int v = 0; v < n; v++) {
+    s.left[v] = s.part[v];
+  }
+  uint64_t trace;
+  s.colors[0] = refine(&s, s.left, a->partitions, &trace);
+  s.depth = 0;
+  while (s.colors[s.depth] < n) {
+    if (s.depth + 1 == cap) {
+      cap *= 2;
+      s.left = xrealloc(s.left, cap * n * sizeof(int));
+      s.colors = xrealloc(s.colors, cap * sizeof(int));
+      s.path = xrealloc(s.path, cap * sizeof(int));
+      s.targets = xrealloc(s.targets, cap * sizeof(int));
+      s.traces = xrealloc(s.traces, cap * sizeof(uint64_t));
+    }
+
+    const int *colors = s.left + s.depth * n;
+    const int num_colors = s.colors[s.depth];
+    const int target = find_target(&s, colors, num_colors);
+    int v = 0;
+    while (colors[v] != target) {
+      v++;
+    }
+
+    int *next = s.left + (s.depth + 1) * n;
+    memcpy(next, colors, n * sizeof(int));
+    next[v] = num_colors;
+    s.path[s.depth] = v;
+    s.targets[s.depth] = target;
+    s.colors[s.depth + 1] = refine(&s, next, num_colors + 1, &s.traces[s.depth]);
+    s.depth++;
+  }
+
+  // Back up the first path, extending the generators to each stabilizer
+  s.right = xmalloc((s.depth + 1) * n * sizeof(int));
+  for (int v = 0; v < n; v++) {
+    s.orbits[v] = v;
+  }
+  for (int level = s.depth - 1; level >= 0 && a->complete; level--) {
+    const int *colors = s.left + level * n;
+    const int v = s.path[level];
+    for (int w = 0; w < n && a->complete; w++) {
+      if (colors[w] != s.targets[level] ||
+          find_orbit(s.orbits, w) == find_orbit(s.orbits, v)) {
+        continue;
+      }
+      try_image(&s, level, colors, s.colors[level], w);
+    }
+
+    int orbit = 0;
+    for (int w = 0; w < n; w++) {
+      if (colors[w] == s.targets[level] &&
+          find_orbit(s.orbits, w) == find_orbit(s.orbits, v)) {
+        orbit++;
+      }
+    }
+    a->log_order += log10(orbit);
+  }
+
+  // Order the generators from the top of the first path down
+  for (int i = 0, j = a->num_generators - 1; i < j; i++, j--) {
+    int *temp = a->generators[i];
+    a->generators[i] = a->generators[j];
+    a->generators[j] = temp;
+  }
+
+  xfree(s.part);
+  xfree(s.index);
+  xfree(s.keys);
+  xfree(s.map);
+  xfree(s.orbits);
+  xfree(s.adj_start);
+  xfree(s.adj);
+  xfree(s.left);
+  xfree(s.colors);
+  xfree(s.path);
+  xfree(s.targets);
+  xfree(s.traces);
+  xfree(s.right);
+  return a;
+}
+
+
+/** @brief Frees memory allocated by a set of generators.
+ *
+ *  @param a  A pointer to the generators.
+ */
+void automorphism_free(automorphism_t *a) {
+  for (int i = 0; i < a->num_generators; i++) {
+    xfree(a->generators[i]);
+  }
+  xfree(a->generators);
+  xfree(a->offsets);
+  xfree(a);
+}
+
+
+/** @brief Gets the number of generators found.
+ *
+ *  @param a  A pointer to the generators.
+ *  @return   The number of generators.
+ */
+int automorphism_get_num_generators(automorphism_t *a) {
+  return a->num_generators;
+}
+
+
+/** @brief Gets the image of a node under a generator.
+ *
+ *  @param a    A pointer to the generators.
+ *  @param gen  The index of the generator.
+ *  @param p    The partition of the node, which is also that of its image.
+ *  @param n    The node number in the partition.
+ *  @return     The node number of the image in partition p.
+ */
+int automorphism_get_image(automorphism_t *a, int gen, int p, int n) {
+  return a->generators[gen][a->offsets[p] + n] - a->offsets[p];
+}
+
+
+/** @brief Gets the base 10 logarithm of the order of the group generated.
+ *
+ *  @param a  A pointer to the generators.
+ *  @return   The logarithm of the order, exact if the search was complete.
+ */
+double automorphism_get_log_order(automorphism_t *a) {
+  return a->log_order;
+}
+
+
+/** @brief Checks whether the search finished within its limit.
+ *
+ *  @param a  A pointer to the generators.
+ *  @return   true if the generators span the whole automorphism group.
+ */
+bool automorphism_is_complete(automorphism_t *a) {
+  return a->complete;
+}
@@ -0,0 +1,57 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+
+/** @file automorphism.h
+ *  @brief Generators of the automorphism group of a k-partite graph.
+ *
+ *  See automorphism.c for documentation and implementation details.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#ifndef _AUTOMORPHISM_H_
+#define _AUTOMORPHISM_H_
+
+#include <stdbool.h>
+
+#include "graph.h"
+
+/** @brief Defines a set of generators of the automorphisms of a graph.
+ *
+ *  See automorphism.c for struct fields and motivation.
+ */
+typedef struct automorphism_group automorphism_t;
+
+
+/** Automorphism API */
+
+/** Creation and free functions */
+automorphism_t *automorphism_find(graph_t *g, long search_limit);
+void automorphism_free(automorphism_t *a);
+
+/** Getters */
+int automorphism_get_num_generators(automorphism_t *a);
+int automorphism_get_image(automorphism_t *a, int gen, int p, int n);
+double automorphism_get_log_order(automorphism_t *a);
+bool automorphism_is_complete(automorphism_t *a);
+
+#endif /* _AUTOMORPHISM_H_ */
@@ -27,8 +27,6 @@
  *  Many of the graph add() and remove() functions take in (p1, n1, p2, n2)
  *  arguments, which could take up less space if encapsulated in a struct.
  *
- *  Randomize flipping edges?
- *
  *  ///////////////////////////////////////////////////////////////////////////
  *  // USAGE
  *  ///////////////////////////////////////////////////////////////////////////
@@ -45,74 +43,562 @@
  *  @bug No known bugs.
  */
 
+#define _DEFAULT_SOURCE  // For mkdir()
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <getopt.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <assert.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 #include "xmalloc.h"
 #include "graph.h"
 #include "mchess.h"
+#include "grid.h"
 #include "pigeon.h"
+#include "coloring.h"
+#include "perturb.h"
+#include "automorphism.h"
 #include "additionalgraphs.h"
+#include "cnf.h"
+#include "rng.h"
+#include "writer.h"
+#include "ordering.h"
+
+/** @brief Bounds on the sifting search run by -O. */
+#define SIFT_WINDOW   32
+#define SIFT_PASSES   4
+
+/** @brief Refinement rounds spent looking for graph automorphisms (-A). */
+#define AUTOMORPHISM_SEARCH_LIMIT  2000000
 
 /** @brief Generates blocked clauses of perfect matchings up to this size. */
 static int blocked_clause_size = -1;
 
+/** @brief Index of the first blocked clause in the generated formula. */
+static int blocked_clause_start = 0;
+
+/** @brief Writes this many replicas keeping a random subset of the blocked
+ *         clauses, each with probability blocking_prob (as a fixed count).
+ */
+static int blocking_replicas = 0;
+static double blocking_prob = 1.0;
+
+/** @brief Adds at most this many lex-leader clauses from the automorphisms
+ *         of the graph (-A).
+ */
+static int lex_leader_cap = 0;
+
 static int rand_seed = 0;
 
-FILE *pgbdd_bucket_f, *pgbdd_var_f;
-int *aux_var_map1, *aux_var_map2;
+/** @brief Writes this many instances (FNAMEFlip<i>.cnf), each this many
+ *         random edge flips away from the generated graph (-N, -F).
+ */
+static int perturb_instances = 1;
+static int perturb_flips = 0;
+
+/** @brief Output files go this many levels of two-hex-digit directories
+ *         deep, named by a hash of the file name (-H).
+ */
+static int shard_levels = 0;
+
+/** @brief Writes a sidecar index of clause sections (FNAME.sections). */
+static bool section_index = false;
+
+/** @brief Scrambles variable names, polarities, and clause/literal order. */
+static bool scramble = false;
+static int scramble_seed = 0;
+
+/** @brief A growable list of variables, written out as a PGBDD order file.
+ *
+ *  Orders are collected in memory while the formula is built, so they can
+ *  be renamed by the same variable map as the formula before being written.
+ */
+typedef struct variable_order {
+  int *vars;
+  int size;
+  int cap;
+} order_t;
+
+/** @brief PGBDD orders.
+ *
+ *  chain:   Variables in the order the AMO encoders emit them, each
+ *           auxiliary variable between the edges it links. Written as the
+ *           variable order with -p.
+ *  row:     Edges node by node, each followed by the auxiliary variable
+ *           after it in its chain. Written as the variable order with -o.
+ *  bucket:  Bucket permutation for the -p variable order.
+ */
+static order_t pgbdd_chain_order, pgbdd_row_order, pgbdd_bucket_order;
+
+/** @brief Placement of auxiliary variables next to one edge variable.
+ *
+ *  An edge is in at most one AMO chain per partition, so it has at most
+ *  two auxiliary variables after it (and two before it) in the chains.
+ *
+ *  edge:    The edge variable, or 0 if the slot is empty.
+ *  placed:  Whether the edge is already in the chain order.
+ *  after:   Auxiliary variables following the edge in its chains, or 0.
+ *  before:  Auxiliary variables preceding the edge in its chains, or 0.
+ */
+typedef struct aux_entry {
+  int edge;
+  bool placed;
+  int after[2];
+  int before[2];
+} aux_entry_t;
+
+/** @brief Open-addressing hash map from edge variables to aux_entry_t.
+ *
+ *  Edge variables are named for every possible edge, so an array indexed
+ *  by them is sized p0 * p1 even for sparse graphs. The map is sized by
+ *  the edges actually in the graph instead, with linear probing.
+ */
+typedef struct aux_map {
+  aux_entry_t *slots;
+  int cap;
+  int size;
+} aux_map_t;
+
+static aux_map_t aux_map = { NULL, 0, 0 };
+
+/** @brief At least or at most one edge from each node of partition p1 to
+ *         partition p2.
+ *
+ *  guard:   A partition whose edges switch nodes on, through an auxiliary
+ *           variable per node implied by each of them; or -1. An "at least
+ *           one" constraint applies to a node of p1 only if it is switched
+ *           on, an "at most one" counts only switched on nodes of p2.
+ *  groups:  For "at most one" constraints, subsets of the nodes of p2 (each
+ *           sorted) that get one constraint each, over the neighbors in
+ *           the subset, instead of one over all neighbors; or NULL.
+ */
+typedef struct constraint {
+  int p1;
+  int p2;
+  int guard;
+  const int **groups;
+  int *group_sizes;
+  int num_groups;
+} constraint_t;
+
 static bool pgbdd_bucket = false;
 static bool pgbdd_var_ord = false;
+static bool pgbdd_ordering = false;
+
+/** @brief Writes a bucket elimination schedule (FNAME.schedule). */
+static bool schedule = false;
+
+/** @brief Heuristic for the optimized variable order (rcm|minfill|sift). */
+static char *order_heuristic = NULL;
 static bool randomGr = false;
 static int verbosity_level = 0;
 
 static void print_help(char *runtime_path) {
   printf("\n%s: BiPartGen Hard CNF Generator\n", runtime_path);
   printf("Developed by: Joseph Reeves and Cayden Codel\n\n");
+  printf("  -A <int>      Add at most this many lex-leader clauses from the automorphisms of the graph.\n");
   printf("  -b <size>     Block perfect matchings up to this size.\n");
+  printf("  -B <base>     Structure of -g random graphs before their random edges (tree|none|ust|matching).\n");
+  printf("  -K <int>      Write this many replicas with a random subset of blocked clauses.\n");
+  printf("  -P <float>    Fraction of blocked clauses kept in each replica.\n");
   printf("  -c <int>      Cardinality (difference in partition size)\n");
   printf("  -E <int>      Edge count for graph\n");
   printf("  -D <float>    Density for random graphs.\n");
   printf("  -e <method>   Specify encoding variant (direct|linear|sinz|mixed).\n");
-  printf("  -f <name>     Output file to write CNF to.\n");
-  printf("  -g <graph>    Specify type of problem (chess|pigeon|random).\n");
+  printf("  -f <name>     Output file to write CNF to, with fields {g}, {e}, {n}, {c} and {seed} filled in.\n");
+  printf("  -F <int>      Also write instances this many random edge flips away from the graph.\n");
+  printf("  -d <dims>     Grid dimensions for -g grid, e.g. 6x8 or 4x4x4 (default nxn).\n");
+  printf("  -g <graph>    Specify type of problem (chess|cylinder|torus|grid|pigeon|fphp|onto|rphp|coloring|\n");
+  printf("                random|regular|powerlaw|planted).\n");
   printf("  -h            Display this help message.\n");
+  printf("  -H <int>      Write files this many levels of hash-named directories deeper.\n");
+  printf("  -I            Write an index of clause sections (FNAME.sections).\n");
+  printf("  -k <int>      Degree of -g regular, average degree of -g powerlaw|planted (default 3),\n");
+  printf("                resting places of -g rphp (default 2n).\n");
   printf("  -L            Use an additional \"At least one\" encoding.\n");
   printf("  -M            Use an additional \"At most one\" encoding.\n");
   printf("  -n <size>     Size of problem (nxn chess, n holes, n nodes).\n");
+  printf("  -N <int>      Number of instances written with -F (default 1).\n");
   printf("  -s <int>      Randomization seed, if applicable.\n");
-  printf("  -p            Bucket permutation (used for Sinz encoding).\n");
-  printf("  -o            Variable ordering (used for linear and Sinz encoding).\n");
+  printf("  -S <int>      Scramble variable names, signs, and clause order with this seed.\n");
+  printf("  -r <cells>    Cells removed from -g grid, e.g. 0,0:5,7 (default opposite corners).\n");
+  printf("  -R <first:last>  Write a -g random formula for each seed in the range (FNAMES<seed>.cnf).\n");
+  printf("  -p            Bucket permutation and chain variable ordering.\n");
+  printf("  -O <method>   Also write an optimized variable order (rcm|minfill|sift).\n");
+  printf("  -o            Row variable ordering (FNAME_ord_variable.order with -p).\n");
+  printf("  -T            Write a bucket elimination schedule of the variable order (FNAME.schedule).\n");
   printf("  -v            Verbosity level 1 (print graph density).\n");
+  printf("  -x <float>    Degree exponent of -g powerlaw, above 2 (default 2.5).\n");
+}
+
+/********** PGBDD Orderings ************/
+
+/** @brief Appends a variable to an order.
+ *
+ *  @param o    A pointer to the order.
+ *  @param var  The variable to append.
+ */
+static void order_append(order_t *o, int var) {
+  if (o->size == o->cap) {
+    o->cap = (o->cap == 0) ? 256 : 2 * o->cap;
+    o->vars = xrealloc(o->vars, o->cap * sizeof(int));
+  }
+  o->vars[o->size++] = var;
+}
+
+/** @brief Appends the variables up to num_vars missing from an order.
+ *
+ *  Slots hold two auxiliary variables per side of an edge, which covers
+ *  one AMO chain per partition. Edges in more chains (e.g. the cliques of
+ *  a coloring) leave the rest to be appended here.
+ *
+ *  @param o         A pointer to the order.
+ *  @param num_vars  The number of variables in the formula.
+ */
+static void order_complete(order_t *o, int num_vars) {
+  bool *seen = xcalloc(num_vars + 1, sizeof(bool));
+  for (int i = 0; i < o->size; i++) {
+    if (o->vars[i] <= num_vars) seen[o->vars[i]] = true;
+  }
+  for (int v = 1; v <= num_vars; v++) {
+    if (!seen[v]) order_append(o, v);
+  }
+  xfree(seen);
+}
+
+/** @brief Sizes the aux map for a number of edges, at most half full.
+ *
+ *  @param m          A pointer to the map.
+ *  @param num_edges  The number of edges in the graph.
+ */
+static void aux_map_init(aux_map_t *m, int num_edges) {
+  m->cap = 16;
+  while (m->cap < 2 * num_edges) {
+    m->cap *= 2;
+  }
+  m->slots = xcalloc(m->cap, sizeof(aux_entry_t));
+  m->size = 0;
+}
+
+/** @brief Finds the entry of an edge variable.
+ *
+ *  @param m       A pointer to the map.
+ *  @param edge    The edge variable, positive.
+ *  @param insert  Whether to add an empty entry if there is none.
+ *  @return        The entry, or NULL if absent and not inserted.
+ */
+static aux_entry_t *aux_map_get(aux_map_t *m, int edge, bool insert) {
+  unsigned int h = ((unsigned int) edge * 2654435761u) & (m->cap - 1);
+  while (m->slots[h].edge != 0) {
+    if (m->slots[h].edge == edge) {
+      return &m->slots[h];
+    }
+    h = (h + 1) & (m->cap - 1);
+  }
+
+  if (!insert) {
+    return NULL;
+  }
+  assert(2 * (m->size + 1) <= m->cap);
+  m->size++;
+  m->slots[h].edge = edge;
+  return &m->slots[h];
+}
+
+/** @brief Records an auxiliary variable in the first free of two slots. */
+static void aux_slot_add(int *slots, int aux) {
+  if (slots[0] == 0) {
+    slots[0] = aux;
+  } else if (slots[1] == 0) {
+    slots[1] = aux;
+  }
+}
+
+/** @brief Appends the recorded auxiliary variables of a slot pair. */
+static void order_append_aux(order_t *o, const int *slots) {
+  for (int k = 0; k < 2 && slots[k] > 0; k++) {
+    order_append(o, slots[k]);
+  }
+}
+
+/** @brief Places an edge variable next in the chain order.
+ *
+ *  Called by the encoders as they emit AMO constraints. An edge in two
+ *  constraints (e.g. with -M) is placed only the first time.
+ *
+ *  @param edge  The edge variable.
+ */
+static void order_place_edge(int edge) {
+  if (!pgbdd_ordering) {
+    return;
+  }
+  aux_entry_t *e = aux_map_get(&aux_map, edge, true);
+  if (e->placed) {
+    return;
+  }
+  e->placed = true;
+  order_append(&pgbdd_chain_order, edge);
+}
+
+/** @brief Places an auxiliary variable between two edges of a chain.
+ *
+ *  @param prev  The edge variable before aux in the chain.
+ *  @param aux   The auxiliary variable.
+ *  @param next  The edge variable after aux in the chain.
+ */
+static void order_place_aux(int prev, int aux, int next) {
+  if (!pgbdd_ordering) {
+    return;
+  }
+  aux_slot_add(aux_map_get(&aux_map, prev, true)->after, aux);
+  aux_slot_add(aux_map_get(&aux_map, next, true)->before, aux);
+  order_append(&pgbdd_chain_order, aux);
+}
+
+/********** Output paths ************/
+
+/** @brief Returns a new string of a path followed by a suffix.
+ *
+ *  @param path    The path.
+ *  @param suffix  The suffix, e.g. ".cnf".
+ *  @return        The concatenation, to be freed by the caller.
+ */
+static char *path_concat(const char *path, const char *suffix) {
+  const size_t len = strlen(path), suffix_len = strlen(suffix);
+  char *res = xmalloc(len + suffix_len + 1);
+  memcpy(res, path, len);
+  memcpy(res + len, suffix, suffix_len + 1);
+  return res;
+}
+
+/** @brief Returns a new string with each {field} of a name template
+ *         replaced by a value.
+ *
+ *  @param tmpl   The name template, e.g. "{g}{e}N{n}S{seed}".
+ *  @param field  The field, with its braces, e.g. "{n}".
+ *  @param value  The value.
+ *  @return       The name, to be freed by the caller.
+ */
+static char *replace_field(const char *tmpl, const char *field, const char *value) {
+  const size_t field_len = strlen(field), value_len = strlen(value);
+  size_t count = 0;
+  for (const char *t = strstr(tmpl, field); t != NULL; t = strstr(t + field_len, field)) {
+    count++;
+  }
+
+  char *res = xmalloc(strlen(tmpl) + count * value_len + 1);
+  char *out = res;
+  const char *t;
+  while ((t = strstr(tmpl, field)) != NULL) {
+    memcpy(out, tmpl, t - tmpl);
+    out += t - tmpl;
+    memcpy(out, value, value_len);
+    out += value_len;
+    tmpl = t + field_len;
+  }
+  strcpy(out, tmpl);
+  return res;
+}
+
+/** @brief Replaces a numeric field of a name template, freeing the old
+ *         name; see replace_field().
+ */
+static char *replace_int_field(char *name, const char *field, int value) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%d", value);
+  char *res = replace_field(name, field, buf);
+  xfree(name);
+  return res;
+}
+
+/** @brief Creates the missing directories along a file path, as mkdir -p.
+ *
+ *  Directories created at the same time by another process are fine.
+ *
+ *  @param path  The path of a file.
+ */
+static void make_dirs(const char *path) {
+  char *dir = path_concat(path, "");
+  for (char *sep = strchr(dir + 1, '/'); sep != NULL; sep = strchr(sep + 1, '/')) {
+    *sep = '\0';
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+      fprintf(stderr, "Could not create directory %s\n", dir);
+      exit(-1);
+    }
+    *sep = '/';
+  }
+  xfree(dir);
+}
+
+/** @brief Returns the path an output base name is written under.
+ *
+ *  With -H, the file name part goes shard_levels directories deeper, each
+ *  named by two hex digits of its (FNV-1a) hash, e.g. out/chess8 becomes
+ *  out/3f/a2/chess8 with -H 2, so large suites spread over directories.
+ *  The directories of the path are created.
+ *
+ *  @param name  The base name, e.g. -f after template expansion.
+ *  @return      The path, to be freed by the caller.
+ */
+static char *output_base(const char *name) {
+  const char *file = strrchr(name, '/');
+  file = (file == NULL) ? name : file + 1;
+
+  uint32_t hash = 2166136261u;
+  for (const char *c = file; *c != '\0'; c++) {
+    hash = (hash ^ (unsigned char) *c) * 16777619u;
+  }
+  // Mix the last characters into the high bits too (MurmurHash3 finalizer)
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35u;
+  hash ^= hash >> 16;
+
+  const size_t dir_len = file - name;
+  char *res = xmalloc(strlen(name) + 3 * shard_levels + 1);
+  memcpy(res, name, dir_len);
+  char *out = res + dir_len;
+  for (int i = 0; i < shard_levels; i++) {
+    // Two hex digits per level, from the high bits down, wrapping around
+    snprintf(out, 4, "%02x/", (unsigned int) (hash >> (24 - 8 * (i % 4))) & 0xff);
+    out += 3;
+  }
+  strcpy(out, file);
+  make_dirs(res);
+  return res;
+}
+
+/** @brief Opens an output file for writing, exiting if it cannot.
+ *
+ *  @param path  The path.
+ *  @return      The open file.
+ */
+static FILE *open_output(const char *path) {
+  FILE *f = fopen(path, "w+");
+  if (f == NULL) {
+    fprintf(stderr, "Could not open %s for writing\n", path);
+    exit(-1);
+  }
+  return f;
+}
+
+/** @brief Writes an order file, one variable per line, and empties the order.
+ *
+ *  @param o        A pointer to the order.
+ *  @param path     The file to write.
+ *  @param var_map  Signed variable map applied to each variable, or NULL.
+ */
+static void write_order(order_t *o, const char *path, const int *var_map) {
+  FILE *f = open_output(path);
+  writer_t *w = writer_create(f);
+  for (int i = 0; i < o->size; i++) {
+    int var = o->vars[i];
+    if (var_map != NULL) {
+      var = abs(var_map[var]);
+    }
+    writer_write_int(w, var);
+    writer_write_str(w, " \n");
+  }
+  writer_free(w);
+  fclose(f);
+
+  xfree(o->vars);
+  o->vars = NULL;
+  o->size = 0;
+  o->cap = 0;
+}
+
+/** @brief Writes the elimination tree and clause buckets of an order.
+ *
+ *  The file starts with the induced width, then gives each variable and
+ *  its parent in the elimination tree (0 for roots) in elimination order,
+ *  then each clause index (from 0) and the variable of its bucket:
+ *
+ *    c induced width W
+ *    e <var> <parent>
+ *    b <clause> <var>
+ *
+ *  @param cnf    The formula, as written.
+ *  @param order  A permutation of its variables, eliminated first to last.
+ *  @param path   The file to write.
+ *  @return       The induced width of the order.
+ */
+static int write_schedule(cnf_t *cnf, const int *order, const char *path) {
+  const int nvars = cnf_get_num_vars(cnf);
+  const int num_clauses = cnf_get_num_clauses(cnf);
+  int *parent = xmalloc(sizeof(int) * (nvars + 1));
+  int *bucket = xmalloc(sizeof(int) * (num_clauses + 1));
+  const int width = ordering_elimination_tree(cnf, order, parent);
+  ordering_clause_buckets(cnf, order, bucket);
+
+  FILE *f = open_output(path);
+  writer_t *w = writer_create(f);
+  writer_write_str(w, "c induced width ");
+  writer_write_int(w, width);
+  writer_write_char(w, '\n');
+  for (int i = 0; i < nvars; i++) {
+    writer_write_str(w, "e ");
+    writer_write_int(w, order[i]);
+    writer_write_char(w, ' ');
+    writer_write_int(w, parent[order[i]]);
+    writer_write_char(w, '\n');
+  }
+  for (int c = 0; c < num_clauses; c++) {
+    writer_write_str(w, "b ");
+    writer_write_int(w, c);
+    writer_write_char(w, ' ');
+    writer_write_int(w, bucket[c]);
+    writer_write_char(w, '\n');
+  }
+  writer_free(w);
+  fclose(f);
+
+  xfree(parent);
+  xfree(bucket);
+  return width;
 }
 
 /********** Graph CNF Encodings ************/
 
 // Functions written assuming a bipartite graph structure for now.
 
+/** @brief Adds the binary clause (l1 v l2).
+ *
+ *  @param cnf  A pointer to the formula.
+ *  @param l1   The first literal.
+ *  @param l2   The second literal.
+ */
+static void add_binary_clause(cnf_t *cnf, int l1, int l2) {
+  cnf_add_lit(cnf, l1);
+  cnf_add_lit(cnf, l2);
+  cnf_add_lit(cnf, 0);
+}
+
 /** @brief Write direct At Most 1 encoding.
  *
- *  @param f               A pointer to the output file.
+ *  @param cnf             A pointer to the formula.
  *  @param edges      An array of the connected nodes.
  *  @param size_edges Size of array edges.
  */
-static void direct_atMost_encoding(FILE *f, int *edges, int size_edges) {
+static void direct_atMost_encoding(cnf_t *cnf, int *edges, int size_edges) {
   int i,j;
   for(i=0; i<size_edges; i++) {
     for(j=i+1; j<size_edges; j++) {
-      fprintf(f, "%d %d 0\n", -edges[i], -edges[j]);
+      add_binary_clause(cnf, -edges[i], -edges[j]);
     }
   }
 }
 
 /** @brief Write linear At Most 1 encoding.
  *
- *  @param f              A pointer to the output file.
+ *  @param cnf            A pointer to the formula.
  *  @param edges     An array of the connected nodes.
  *  @param size_edges Size of array edges.
  *  @param curr_i   Current index into edges.
@@ -121,7 +607,7 @@ static void direct_atMost_encoding(FILE *f, int *edges, int size_edges) {
  *  @return Value of next availiable variable ID.
  */
 static int linear_atMost_encoding(
-                                  FILE *f, int *edges, int size_edges, int curr_i, int ex_var) {
+                                  cnf_t *cnf, int *edges, int size_edges, int curr_i, int ex_var) {
   
   bool linear = (size_edges-curr_i>4)?true:false;
   int s = (linear)?4:(size_edges-curr_i);
@@ -130,20 +616,22 @@ static int linear_atMost_encoding(
   for(int i=0; i<s; i++) {
     if (i == 3 && linear) {
       linear_edges[i] = ex_var;
-      if (pgbdd_var_ord) {
-        aux_var_map1[linear_edges[2]] = ex_var;
-      }
+      order_place_aux(linear_edges[2], ex_var, edges[i+curr_i]);
+    }
+    else {
+      linear_edges[i] = edges[i+curr_i];
+      // The first entry after the first window is the previous aux variable
+      if (linear_edges[i] > 0) order_place_edge(linear_edges[i]);
     }
-    else linear_edges[i] = edges[i+curr_i];
   }
   
   // Direct Encoding for the linear
-  direct_atMost_encoding(f, linear_edges, s);
+  direct_atMost_encoding(cnf, linear_edges, s);
   
   if (linear) {
     edges[curr_i+2] = -ex_var;
     // Recursive Call for remaining variables
-    return linear_atMost_encoding(f,edges,size_edges,curr_i+2,ex_var+1);
+    return linear_atMost_encoding(cnf,edges,size_edges,curr_i+2,ex_var+1);
   }
   else return ex_var;
 }
@@ -160,56 +648,46 @@ static int sinz_variableID(int i, int sinz_var) {
 
 /** @brief Write Sinz At Most 1 encoding.
  *
- *  @param f                   A pointer to the output file.
+ *  @param cnf                 A pointer to the formula.
  *  @param edges          An array of the connected nodes.
  *  @param size_edges Size of array edges.
  *  @param sinz_var   First ID of sinz variable, updated before return.
  *
  *  @return Value of next availiable variable ID.
  */
-static int sinz_atMost_encoding(FILE *f, int *edges, int size_edges, int sinz_var) {
+static int sinz_atMost_encoding(cnf_t *cnf, int *edges, int size_edges, int sinz_var) {
   
   if (size_edges == 2) {
     if (randomGr) {
-      fprintf(f, "%d %d 0\n", -edges[0], sinz_variableID(0,sinz_var));
-      fprintf(f, "%d %d 0\n", -edges[1], -sinz_variableID(0,sinz_var));
-      if (pgbdd_bucket) {
-        fprintf(pgbdd_var_f,"%d \n", edges[0]);
-        fprintf(pgbdd_var_f,"%d \n", sinz_variableID(0,sinz_var));
-        fprintf(pgbdd_var_f,"%d \n", edges[1]);
-        aux_var_map1[edges[1]] = sinz_variableID(0,sinz_var);
-        return sinz_variableID(size_edges-1,sinz_var);
-      }
-      else if (pgbdd_var_ord) {
-        aux_var_map1[edges[0]] = sinz_variableID(0,sinz_var);
-        return sinz_variableID(size_edges-1,sinz_var);
-      }
+      add_binary_clause(cnf, -edges[0], sinz_variableID(0,sinz_var));
+      add_binary_clause(cnf, -edges[1], -sinz_variableID(0,sinz_var));
+      order_place_edge(edges[0]);
+      order_place_aux(edges[0], sinz_variableID(0,sinz_var), edges[1]);
+      order_place_edge(edges[1]);
       return sinz_var + 1;
     }
     else {
-      fprintf(f, "%d %d 0\n", -edges[0], -edges[1]);
+      add_binary_clause(cnf, -edges[0], -edges[1]);
+      order_place_edge(edges[0]);
+      order_place_edge(edges[1]);
       return sinz_var;
     }
   }
   else {
-    if (pgbdd_bucket) fprintf(pgbdd_var_f,"%d \n", edges[0]);
+    order_place_edge(edges[0]);
     for(int i = 0; i < size_edges; i++) {
       if (i < (size_edges-1)) {
         // signal variable (no signal for last variable Xn)
-        fprintf(f, "%d %d 0\n", -edges[i], sinz_variableID(i,sinz_var));
-        if (pgbdd_bucket) {
-          fprintf(pgbdd_var_f,"%d \n", sinz_variableID(i,sinz_var));
-          fprintf(pgbdd_var_f,"%d \n", edges[i+1]);
-          aux_var_map1[edges[i+1]] = sinz_variableID(i,sinz_var);
-        }
-        else if (pgbdd_var_ord) aux_var_map1[edges[i]] = sinz_variableID(i,sinz_var);
+        add_binary_clause(cnf, -edges[i], sinz_variableID(i,sinz_var));
+        order_place_aux(edges[i], sinz_variableID(i,sinz_var), edges[i+1]);
+        order_place_edge(edges[i+1]);
       }
       if (i > 0) {
         // Not previous signal and current variable
-        fprintf(f, "%d %d 0\n", -edges[i], -sinz_variableID(i-1,sinz_var));
+        add_binary_clause(cnf, -edges[i], -sinz_variableID(i-1,sinz_var));
         if (i < (size_edges - 1)) {
           // signal propogates forward
-          fprintf(f, "%d %d 0\n", -sinz_variableID(i-1,sinz_var), sinz_variableID(i,sinz_var));
+          add_binary_clause(cnf, -sinz_variableID(i-1,sinz_var), sinz_variableID(i,sinz_var));
         }
       }
     }
@@ -219,6 +697,35 @@ static int sinz_atMost_encoding(FILE *f, int *edges, int size_edges, int sinz_va
   return 0;
 }
 
+/** @brief Get the number of edge variable IDs before a pair of partitions.
+ *
+ *   Pairs of partitions (a, b), a < b, are named in order, each with an ID
+ *   for every possible edge. Bipartite graphs have only the pair (0, 1).
+ *
+ *  @param g  A pointer to the graph structure.
+ *  @param p1 The index of one partition.
+ *  @param p2 The index of the other partition.
+ */
+static int get_pair_offset(graph_t *g, int p1, int p2) {
+  const int k = graph_get_num_partitions(g);
+  if (k == 2) {
+    return 0;
+  }
+
+  const int *partition_sizes = graph_get_partition_sizes(g);
+  const int a = (p1<p2)?p1:p2, b = (p1<p2)?p2:p1;
+  int offset = 0;
+  for (int x = 0; x < k; x++) {
+    for (int y = x + 1; y < k; y++) {
+      if (x == a && y == b) {
+        return offset;
+      }
+      offset += partition_sizes[x] * partition_sizes[y];
+    }
+  }
+  return offset;
+}
+
 /** @brief Get edge variable ID.
  *
  *   Edge variable IDs given for evert possible edge. Count up from all
@@ -235,221 +742,393 @@ static int get_variableID(graph_t *g, int p1, int n1, int p2, int n2) {
   int s = (p1<p2)?p2:p1;
   int n1N =(p1<p2)?n1:n2;
   int n2N =(p1<p2)?n2:n1;
-  return (1 + n2N + (graph_get_partition_sizes(g)[s] * n1N));
+  return (1 + get_pair_offset(g, p1, p2) + n2N + (graph_get_partition_sizes(g)[s] * n1N));
 }
 
-/** @brief Extract CNF formulas from graph.
+/** @brief Get the edge variable IDs of one node's row.
  *
+ *   The ID of the edge from (p1, n1) to (p2, n2) is base + n2 * stride,
+ *   so a row of edges is named without calling get_variableID() per edge.
+ *
+ *  @param g           A pointer to the graph structure.
+ *  @param p1          The index of the partition the node is in.
+ *  @param n1          The node number of the node.
+ *  @param p2          The index of the partition the node is "querying."
+ *  @param base[out]   The ID of the edge to node 0 of p2.
+ *  @param stride[out] The difference in ID between consecutive nodes of p2.
+ */
+static void get_variable_row(graph_t *g, int p1, int n1, int p2,
+    int *base, int *stride) {
+  int s = (p1<p2)?p2:p1;
+  const int size = graph_get_partition_sizes(g)[s];
+  const int offset = get_pair_offset(g, p1, p2);
+  if (p1 < p2) {
+    *base = 1 + offset + size * n1;
+    *stride = 1;
+  } else {
+    *base = 1 + offset + n1;
+    *stride = size;
+  }
+}
+
+/** @brief Gets the variable switching constraints on node n of partition
+ *         p, defining it on first use.
+ *
+ *  Each edge from the node to partition guard implies the variable, so it
+ *  is true whenever the node is used. A partition is guarded by a single
+ *  other partition, so the variables are kept per partition.
+ *
+ *  @param cnf          A pointer to the formula.
+ *  @param g            A pointer to the graph structure.
+ *  @param switch_vars  Per partition, the variable of each node or 0.
+ *  @param p            The partition of the node.
+ *  @param n            The node number of the node.
+ *  @param guard        The partition whose edges switch the node on.
+ *  @param ex_var       Next availiable variable ID, advanced if used.
+ *
+ *  @return The switching variable.
+ */
+static int get_switch_var(cnf_t *cnf, graph_t *g, int **switch_vars,
+    int p, int n, int guard, int *ex_var) {
+  if (switch_vars[p] == NULL) {
+    switch_vars[p] = xcalloc(graph_get_partition_sizes(g)[p], sizeof(int));
+  }
+  if (switch_vars[p][n] == 0) {
+    const int q = (*ex_var)++;
+    for(int m = graph_get_next_neighbor(g, p, n, guard, 0); m >= 0;
+        m = graph_get_next_neighbor(g, p, n, guard, m + 1)) {
+      add_binary_clause(cnf, -get_variableID(g,p,n,guard,m), q);
+    }
+    switch_vars[p][n] = q;
+  }
+  return switch_vars[p][n];
+}
+
+/** @brief Write one At Most 1 constraint over edges of a node.
+ *
+ *  @param cnf    A pointer to the formula.
+ *  @param g      A pointer to the graph structure.
+ *  @param en     The translation encoding type (mixed picks one at random).
+ *  @param p1     The partition of the node.
+ *  @param n1     The node number of the node.
+ *  @param p2     The partition of the connected nodes.
+ *  @param nodes  The connected nodes of p2 in the constraint.
+ *  @param size   Size of nodes.
+ *  @param switches Variables switching each edge on, parallel to nodes,
+ *                  or NULL if every edge counts.
+ *  @param ex_var Next availiable variable ID.
+ *
+ *  @return Value of next availiable variable ID.
+ */
+static int write_atMost_constraint(cnf_t *cnf, graph_t *g, const char *en,
+    int p1, int n1, int p2, const int *nodes, int size, const int *switches,
+    int ex_var) {
+  if (size <= 1) {
+    return ex_var;
+  }
+
+  // At least two nodes
+  int *edges = xmalloc(size * sizeof(int));
+  char section_name[64];
+  // Get edge variable names
+  for(int n = 0; n < size; n++) {
+    edges[n] = get_variableID(g,p1,n1,p2,nodes[n]);
+  }
+  if (strcmp(en,"mixed")==0) { // mixed encoding selects from three encoding options
+    int r = rand() % 3;
+    if (r==0) {
+      en = "direct";
+    }
+    else if (r==1) {
+      en = "sinz";
+    }
+    else {
+      en = "linear";
+    }
+  }
+  if (section_index) {
+    // Sinz and linear AMO clauses form a chain over auxiliary variables
+    snprintf(section_name, sizeof(section_name), "%s %d %d %s",
+        (strcmp(en,"direct")==0) ? "amo" : "aux", p1, n1, en);
+    cnf_begin_section(cnf, section_name);
+  }
+  if (switches != NULL && strcmp(en,"direct")==0) {
+    // Two edges conflict only if both are switched on
+    for(int n = 0; n < size; n++) order_place_edge(edges[n]);
+    for(int n = 0; n < size; n++) {
+      for(int m = n + 1; m < size; m++) {
+        cnf_add_lit(cnf, -switches[n]);
+        cnf_add_lit(cnf, -switches[m]);
+        add_binary_clause(cnf, -edges[n], -edges[m]);
+      }
+    }
+    free(edges);
+    return ex_var;
+  } else if (switches != NULL) {
+    // The encodings below range over y, with a switched on edge implying y
+    for(int n = 0; n < size; n++) {
+      const int y = ex_var++;
+      cnf_add_lit(cnf, -switches[n]);
+      add_binary_clause(cnf, -edges[n], y);
+      edges[n] = y;
+    }
+  }
+  if (strcmp(en,"direct")==0) {
+    // Direct encoding
+    for(int n = 0; n < size; n++) order_place_edge(edges[n]);
+    direct_atMost_encoding(cnf, edges, size);
+    
+  } else if (strcmp(en,"sinz")==0) {
+    // Sinz encoding
+    ex_var = sinz_atMost_encoding(cnf, edges, size, ex_var);
+  }
+  else if (strcmp(en,"linear")==0) {
+    ex_var = linear_atMost_encoding(cnf,edges,size,0,ex_var);
+  }
+  free(edges);
+  return ex_var;
+}
+
+/** @brief Writes lex-leader clauses for generators of the graph's
+ *         automorphisms.
+ *
+ *   Every automorphism that keeps the partitions maps the edge variables
+ *   of a solution to those of another, since each constraint ranges over
+ *   the neighbors of a node in a partition. So the lexicographically least
+ *   image of a solution, over the edge variables by ID, is a solution, and
+ *   for each generator pi the clauses require x <= pi(x). Over the edge
+ *   variables x_j moved by pi, in order, with y_j the variable x_j maps
+ *   to, and e_j meaning the first j of them equal their images:
+ *
+ *     e_{j-1} -> (x_j -> y_j),  e_{j-1} & x_j -> e_j,  e_{j-1} & !y_j -> e_j
+ *
+ *   Stopping a generator early keeps a prefix of its order, which is
+ *   weaker but still holds for the least image, so the clauses stop at
+ *   lex_leader_cap.
+ *
+ *  @param cnf     The formula, with the constraints already added.
+ *  @param g       A pointer to the graph structure.
+ *  @param ex_var  The first free variable.
+ *  @return        The next free variable.
+ */
+static int write_lex_leader_clauses(cnf_t *cnf, graph_t *g, int ex_var) {
+  const int *partition_sizes = graph_get_partition_sizes(g);
+  const int k = graph_get_num_partitions(g);
+  const int num_edge_vars = get_pair_offset(g, k - 2, k - 1) +
+    partition_sizes[k - 2] * partition_sizes[k - 1];
+  automorphism_t *a = automorphism_find(g, AUTOMORPHISM_SEARCH_LIMIT);
+  const int num_gens = automorphism_get_num_generators(a);
+  int *image = xmalloc(sizeof(int) * (num_edge_vars + 1));
+  int *moved = xmalloc(sizeof(int) * (num_edge_vars + 1));
+  char section_name[64];
+
+  int clauses = 0, used = 0;
+  for (int gen = 0; gen < num_gens && clauses < lex_leader_cap; gen++) {
+    memset(image, 0, sizeof(int) * (num_edge_vars + 1));
+    for (int p1 = 0; p1 < k; p1++) {
+      for (int p2 = p1 + 1; p2 < k; p2++) {
+        for (int n1 = 0; n1 < partition_sizes[p1]; n1++) {
+          const int m1 = automorphism_get_image(a, gen, p1, n1);
+          for (int n2 = graph_get_next_neighbor(g, p1, n1, p2, 0); n2 >= 0;
+              n2 = graph_get_next_neighbor(g, p1, n1, p2, n2 + 1)) {
+            const int m2 = automorphism_get_image(a, gen, p2, n2);
+            image[get_variableID(g, p1, n1, p2, n2)] =
+              get_variableID(g, p1, m1, p2, m2);
+          }
+        }
+      }
+    }
+
+    int num_moved = 0;
+    for (int v = 1; v <= num_edge_vars; v++) {
+      if (image[v] != 0 && image[v] != v) {
+        moved[num_moved++] = v;
+      }
+    }
+
+    if (section_index) {
+      snprintf(section_name, sizeof(section_name), "lexleader %d", gen);
+      cnf_begin_section(cnf, section_name);
+    }
+    used++;
+
+    int eq = 0; // e_{j-1}, or 0 while no variable is compared
+    for (int j = 0; j < num_moved; j++) {
+      const int x = moved[j], y = image[moved[j]];
+      if (eq != 0) cnf_add_lit(cnf, -eq);
+      cnf_add_lit(cnf, -x);
+      cnf_add_lit(cnf, y);
+      cnf_add_lit(cnf, 0);
+      clauses++;
+
+      // The next comparison needs e_j and its two clauses first
+      if (j == num_moved - 1 || clauses + 3 > lex_leader_cap) {
+        break;
+      }
+      const int next_eq = ex_var++;
+      if (eq != 0) cnf_add_lit(cnf, -eq);
+      cnf_add_lit(cnf, -x);
+      cnf_add_lit(cnf, next_eq);
+      cnf_add_lit(cnf, 0);
+      if (eq != 0) cnf_add_lit(cnf, -eq);
+      cnf_add_lit(cnf, y);
+      cnf_add_lit(cnf, next_eq);
+      cnf_add_lit(cnf, 0);
+      clauses += 2;
+      eq = next_eq;
+    }
+  }
+
+  printf("%d lex-leader clauses from %d of %d automorphism generators\n",
+      clauses, used, num_gens);
+  if (verbosity_level > 0) {
+    printf("Automorphism group order: 10^%.2f%s\n",
+        automorphism_get_log_order(a),
+        automorphism_is_complete(a) ? "" : " (at least, search limit reached)");
+  }
+
+  xfree(image);
+  xfree(moved);
+  automorphism_free(a);
+  return ex_var;
+}
+
+/** @brief Extract CNF formulas from graph into an empty formula.
+ *
+ *  The formula is built in memory; the number of variables in the header
+ *  is set from the auxiliary variables actually allocated by the encoders.
+ *
+ *  @param cnf  A pointer to an empty formula.
  *  @param g  A pointer to the graph structure.
- *  @param f  A pointer to the output file.
  *  @param en The translation encoding type
- *  @param atMost1 Partitions to get at most 1 constraints.
- *  @param aLeast1 Partitions to get at least 1 constraints.
+ *  @param atMost1 At most 1 constraints.
+ *  @param aLeast1 At least 1 constraints.
  *  @param atMSize Size of atMost1.
  *  @param atLSize Size of atLeast1.
  */
-static void write_cnf_from_graph(
-                                 graph_t *g, FILE *f, char* en, int* atMost1, int* atLeast1,
+static void fill_cnf_from_graph(cnf_t *cnf,
+                                 graph_t *g, char* en, constraint_t* atMost1, constraint_t* atLeast1,
                                  int atMSize, int atLSize) {
   
   const int *partition_sizes = graph_get_partition_sizes(g);
+  const int k = graph_get_num_partitions(g);
   
   // Vaiable name for every possible edge (many will be unused)
-  int nvars = partition_sizes[0] * partition_sizes[1];
-  int ex_var = nvars+1;
-  int p1,p2, nclauses = 0, nAtLeast = 0, nAtMost = 0,r;
-  int *size_nodes, *connected_nodes, *edges;
-  bool mixed = strcmp(en,"mixed")==0;
-  char* mixed_encodings[partition_sizes[0]+partition_sizes[1]];
+  int ex_var = get_pair_offset(g, k - 2, k - 1) +
+    partition_sizes[k - 2] * partition_sizes[k - 1] + 1;
+  int p1,p2;
+  int *size_nodes, *connected_nodes;
+  char section_name[64];
   
   size_nodes = xmalloc(sizeof(int));
+  int **switch_vars = xcalloc(k, sizeof(int *));
   
   srand(rand_seed);
   
-  // get number of clauses
-  for(int p = 0; p < atLSize; p++) {
-    // at Least 1 clauses
-    p1 = atLeast1[p];
-    p2 = (p1==0)?1:0;
-    for(int i=0; i< partition_sizes[p1]; i++) {
-      connected_nodes = graph_get_neighbors(g, p1, i, p2, size_nodes);
-      if (*size_nodes > 0) nAtLeast++;
-      free(connected_nodes);
-    }
-  }
-  
-  int encCnt = 0;
-  for(int p = 0; p < atMSize; p++) {
-    p1 = atMost1[p];
-    p2 = (p1==0)?1:0;
-    for(int i=0; i < partition_sizes[p1]; i++) {
-      connected_nodes = graph_get_neighbors(g, p1, i, p2, size_nodes);
-      if (*size_nodes > 1) {
-        if (mixed) { // mixed encoding selects from three encoding options
-          r = rand() % 3;
-          if (r==0) {
-            en = "direct";
-          }
-          else if (r==1) {
-            en = "sinz";
-          }
-          else {
-            en = "linear";
-          }
-          mixed_encodings[encCnt++] = en;
-        }
-        if (strcmp(en,"direct")==0) {
-          // Direct encoding
-          nAtMost += (*size_nodes*(*size_nodes-1))/2;
-        } else if (strcmp(en,"sinz")==0) {
-          // Sinz encoding
-          if (*size_nodes > 2) {
-            nvars += (*size_nodes-1); // No ex_var for last var
-            nAtMost += (*size_nodes-2)*3; // constraints for all but first and last var
-            nAtMost += 2; // First and last clauses
-          }
-          else {
-            nAtMost += 1;
-            if (randomGr) {nAtMost++;nvars++;}
-          }
-          // here for pgbdd options
-        }
-        else if (strcmp(en,"linear")==0) {
-          // linear encoding
-          if (*size_nodes == 2) nAtMost += 1;
-          else {
-            nAtMost += 3*(*size_nodes) - 6;
-            nvars += (*size_nodes-3)/2;
-          }
-        }
-        free(connected_nodes);
-      }
-    }
-  }
-  
-  
-  nclauses = nAtMost + nAtLeast;
-  
-  // Blocked clauses here - check options
-  if (blocked_clause_size >= 2) {
-    graph_generate_perfect_matchings(g, blocked_clause_size);
-    
-    /* We consider all perfect matchings on each set of left and right nodes.
-     *
-     * We must leave at least one perfect matching on those nodes, but are
-     *   free to block all but one.
-     *
-     * However, we don't want to reduce the number of solutions, so optionally,
-     *   we keep track of the non-PM edges that are "kept" on a PM block.
-     *   Future blockings of PMs consult a dictionary of these non-PM edges
-     *   and will avoid blocking PMs that have non-PM edges from earlier PM
-     *   blockings.
-     */
-    // TODO hard-coded bipartite
-    const int p1_size = partition_sizes[0];
-    const int p2_size = partition_sizes[1];
-    
-    // Keep track of edges involved in PMs, and edges involved as witnesses
-    int blocked_edges[p1_size][p2_size];
-    int witness_edges[p1_size][p2_size];
-    for (int i = 0; i < p1_size; i++) {
-      for (int j = 0; j < p2_size; j++) {
-        blocked_edges[i][j] = 0;
-        witness_edges[i][j] = 0;
-      }
-    }
-    
-    int matchings_blocked = 0;
-    for (int i = 0; i < p1_size; i++) {
-      if (graph_get_num_matchings(g, 0, i, 1) > 0) {
-        matching_t *m = graph_get_first_matching(g, 0, i, 1);
-        while (m != NULL) {
-          int num_similar = graph_get_num_similar_matchings(m);
-          assert(num_similar >= 2);
-          
-          matchings_blocked += num_similar - 1;
-          m = graph_get_next_set(m);
-        }
-      }
-    }
-    
-    // Now add the number of blocked clauses
-    nclauses += matchings_blocked;
-    printf("%d matchings were blocked\n", matchings_blocked);
-  }
-  
-  // Write Header
-  fprintf(f, "p cnf %d %d\n", nvars, nclauses);
-  
   // Write constraints
   for(int p = 0; p < atLSize; p++) {
     // Write atLeast constraints
-    p1 = atLeast1[p];
-    p2 = (p1==0)?1:0;
+    p1 = atLeast1[p].p1;
+    p2 = atLeast1[p].p2;
+    const int guard = atLeast1[p].guard;
+    if (section_index) {
+      snprintf(section_name, sizeof(section_name), "alo %d", p1);
+      cnf_begin_section(cnf, section_name);
+    }
     for(int i=0; i< partition_sizes[p1]; i++) {
       connected_nodes = graph_get_neighbors(g, p1, i, p2, size_nodes);
       if (*size_nodes > 0) {
+        if (guard >= 0) {
+          // q switches the constraint on
+          cnf_add_lit(cnf, -get_switch_var(cnf, g, switch_vars, p1, i, guard,
+                &ex_var));
+        }
         //At least one node
         for(int n = 0; n < *size_nodes; n++) {
-          fprintf(f, "%d ", get_variableID(g,p1,i,p2,connected_nodes[n]));
+          cnf_add_lit(cnf, get_variableID(g,p1,i,p2,connected_nodes[n]));
         }
-        fprintf(f, "0\n");
+        cnf_add_lit(cnf, 0);
       }
       free(connected_nodes);
     }
   }
   
-  encCnt = 0;
+  int max_size = 1;
+  for(int p = 0; p < k; p++) {
+    if (partition_sizes[p] > max_size) max_size = partition_sizes[p];
+  }
+  int *group_nodes = xmalloc(sizeof(int) * max_size);
+  int *switches = xmalloc(sizeof(int) * max_size);
   for(int p = 0; p < atMSize; p++) {
     // Write atMost constraints
-    p1 = atMost1[p];
-    p2 = (p1==0)?1:0;
+    p1 = atMost1[p].p1;
+    p2 = atMost1[p].p2;
+    const int guard = atMost1[p].guard;
     for(int i=0; i< partition_sizes[p1]; i++) {
       connected_nodes = graph_get_neighbors(g, p1, i, p2, size_nodes);
-      if (*size_nodes > 1) {
-        // At least two nodes
-        edges = xmalloc(*size_nodes * sizeof(int));
-        // Get edge variable names
+      if (guard >= 0) {
         for(int n = 0; n < *size_nodes; n++) {
-          edges[n] = get_variableID(g,p1,i,p2,connected_nodes[n]);
+          switches[n] = get_switch_var(cnf, g, switch_vars, p2,
+              connected_nodes[n], guard, &ex_var);
         }
-        if (mixed) en = mixed_encodings[encCnt++];
-        if (strcmp(en,"direct")==0) {
-          // Direct encoding
-          direct_atMost_encoding(f, edges, *size_nodes);
-          
-        } else if (strcmp(en,"sinz")==0) {
-          // Sinz encoding
-          ex_var = sinz_atMost_encoding(f, edges, *size_nodes, ex_var);
-        }
-        else if (strcmp(en,"linear")==0) {
-          ex_var = linear_atMost_encoding(f,edges,*size_nodes,0,ex_var);
+      }
+      if (atMost1[p].groups == NULL) {
+        ex_var = write_atMost_constraint(cnf, g, en, p1, i, p2,
+            connected_nodes, *size_nodes, (guard >= 0) ? switches : NULL,
+            ex_var);
+      } else {
+        // One constraint per group, over the neighbors in the group
+        for(int c = 0; c < atMost1[p].num_groups; c++) {
+          const int *group = atMost1[p].groups[c];
+          int size = 0;
+          for(int n = 0, m = 0; n < *size_nodes && m < atMost1[p].group_sizes[c];) {
+            if (connected_nodes[n] < group[m]) n++;
+            else if (connected_nodes[n] > group[m]) m++;
+            else {
+              group_nodes[size++] = group[m];
+              n++;
+              m++;
+            }
+          }
+          ex_var = write_atMost_constraint(cnf, g, en, p1, i, p2,
+              group_nodes, size, NULL, ex_var);
         }
-        free(edges);
       }
       free(connected_nodes);
     }
   }
+  xfree(group_nodes);
+  xfree(switches);
+  for(int p = 0; p < k; p++) {
+    xfree(switch_vars[p]);
+  }
+  xfree(switch_vars);
   
   // TODO hard-coded 0 and 1 bipartite
   // Write blocked clauses - same identification protocol as before
-  fprintf(f, "c Below are the blocked clauses from perfect matchings\n");
+  //   (scrambling shuffles clause order, so the marker would be misleading)
+  if (!scramble) {
+    cnf_add_comment(cnf, (lex_leader_cap > 0) ?
+        "Below are the lex-leader clauses from graph automorphisms" :
+        "Below are the blocked clauses from perfect matchings");
+  }
+  blocked_clause_start = cnf_get_num_clauses(cnf);
+  if (lex_leader_cap > 0) {
+    ex_var = write_lex_leader_clauses(cnf, g, ex_var);
+  }
   if (blocked_clause_size >= 2) {
-    const int p1_size = partition_sizes[0];
-    const int p2_size = partition_sizes[1];
+    graph_generate_perfect_matchings(g, blocked_clause_size);
     
-    // Keep track of edges involved in PMs, and edges involved as witnesses
-    int blocked_edges[p1_size][p2_size];
-    int witness_edges[p1_size][p2_size];
-    for (int i = 0; i < p1_size; i++) {
-      for (int j = 0; j < p2_size; j++) {
-        blocked_edges[i][j] = 0;
-        witness_edges[i][j] = 0;
-      }
-    }
+    /* We consider all perfect matchings on each set of left and right nodes.
+     *
+     * We must leave at least one perfect matching on those nodes, but are
+     *   free to block all but one.
+     */
+    const int p1_size = partition_sizes[0];
+    int matchings_blocked = 0;
+    int matching_sets = 0;
     
     for (int i = 0; i < p1_size; i++) {
-      // int num_blocked = 0;
       if (graph_get_num_matchings(g, 0, i, 1) > 0) {
         matching_t *m = graph_get_first_matching(g, 0, i, 1);
         while (m != NULL) {
@@ -460,82 +1139,338 @@ static void write_cnf_from_graph(
           int size = graph_get_matching_size(m);
           const int *p1s = graph_get_matching_left_nodes(m);
           const int *p2s = graph_get_matching_right_nodes(m);
+          if (section_index) {
+            snprintf(section_name, sizeof(section_name), "blocked %d %d",
+                matching_sets, size);
+            cnf_begin_section(cnf, section_name);
+          }
+          matching_sets++;
 
           // Block all but one in this set
           for (int m_idx = 0; m_idx < num_similar - 1; m_idx++) {
             m = graph_get_next_matching(m);
             const int *p2o = graph_get_matching_ordered_right_nodes(m);
             for (int n = 0; n < size; n++) {
-              fprintf(f, "-%d ",
-                  get_variableID(g, 0, p1s[n], 1, p2s[p2o[n]]));
+              cnf_add_lit(cnf,
+                  -get_variableID(g, 0, p1s[n], 1, p2s[p2o[n]]));
             }
-            fprintf(f, "0\n");
+            cnf_add_lit(cnf, 0);
           }
+          matchings_blocked += num_similar - 1;
 
           m = graph_get_next_matching(m);
         }
       }
     }
+    
+    printf("%d matchings were blocked\n", matchings_blocked);
   }
+  
+  xfree(size_nodes);
+  cnf_set_num_vars(cnf, ex_var - 1);
 }
 
-void write_pgbdd_var_ord(graph_t *g) {
+/** @brief Extract CNF formulas from graph, see fill_cnf_from_graph().
+ *
+ *  @return   The CNF formula.
+ */
+static cnf_t *generate_cnf_from_graph(
+                                 graph_t *g, char* en, constraint_t* atMost1, constraint_t* atLeast1,
+                                 int atMSize, int atLSize) {
+  cnf_t *cnf = cnf_create(0);
+  fill_cnf_from_graph(cnf, g, en, atMost1, atLeast1, atMSize, atLSize);
+  return cnf;
+}
+
+/** @brief Writes replicas of the formula keeping a random subset of the
+ *         blocked clauses, as FNAMESeed<i>.cnf for i in 1..K.
+ *
+ *  Replaces blocking_randomizer.py. The matchings are enumerated once, and
+ *  each replica keeps the same number of blocked clauses, chosen by a
+ *  partial Fisher-Yates shuffle of their indexes seeded by -s.
+ *
+ *  @param cnf     The generated formula, blocked clauses last.
+ *  @param fvalue  The base filename.
+ */
+static void write_blocking_replicas(cnf_t *cnf, const char *fvalue) {
+  const int num_blocked = cnf_get_num_clauses(cnf) - blocked_clause_start;
+  const int goal = (int) (num_blocked * blocking_prob);
+  int *idxs = xmalloc(sizeof(int) * (num_blocked + 1));
+  for (int i = 0; i < num_blocked; i++) {
+    idxs[i] = blocked_clause_start + i;
+  }
+
+  rng_t r;
+  rng_seed(&r, rand_seed);
+  const size_t name_len = strlen(fvalue) + 32;
+  char *name = xmalloc(name_len);
+  for (int k = 1; k <= blocking_replicas; k++) {
+    for (int i = 0; i < goal; i++) {
+      int j = i + rng_bounded(&r, num_blocked - i);
+      int tmp = idxs[i];
+      idxs[i] = idxs[j];
+      idxs[j] = tmp;
+    }
+
+    snprintf(name, name_len, "%sSeed%d.cnf", fvalue, k);
+    FILE *f = open_output(name);
+    cnf_write_dimacs_subset(cnf, f, blocked_clause_start, idxs, goal);
+    fclose(f);
+  }
+
+  xfree(name);
+  xfree(idxs);
+}
+
+/** @brief Appends the rows of one pair of partitions to the row order.
+ *
+ *  Each edge is followed by the auxiliary variables after it in its
+ *  chains, then the variables of non-edges follow all rows.
+ *
+ *  @param g    A pointer to the graph structure.
+ *  @param row  The partition whose nodes give the rows.
+ *  @param col  The partition whose nodes give the columns.
+ */
+static void generate_pgbdd_rows(graph_t *g, int row, int col) {
+  const int *partition_sizes = graph_get_partition_sizes(g);
+  int base, stride;
+  for(int i = 0; i < partition_sizes[row]; i++) {
+    get_variable_row(g, row, i, col, &base, &stride);
+    for(int j = graph_get_next_neighbor(g, row, i, col, 0); j >= 0;
+        j = graph_get_next_neighbor(g, row, i, col, j + 1)) {
+      const int var = base + j * stride;
+      order_append(&pgbdd_row_order, var);
+      aux_entry_t *e = aux_map_get(&aux_map, var, false);
+      if (e != NULL) order_append_aux(&pgbdd_row_order, e->after);
+    }
+  }
+
+  // Fill in remaining edges
+  for(int i = 0;i < partition_sizes[row]; i++) {
+    get_variable_row(g, row, i, col, &base, &stride);
+    for(int j = graph_get_next_non_neighbor(g, row, i, col, 0); j >= 0;
+        j = graph_get_next_non_neighbor(g, row, i, col, j + 1)) {
+      order_append(&pgbdd_row_order, base + j * stride);
+    }
+  }
+}
+
+/** @brief Builds the row variable order (-o) from the recorded placement.
+ *
+ *  Graphs with more partitions take the pairs of partitions in turn.
+ *
+ *  @param g  A pointer to the graph structure.
+ */
+static void generate_pgbdd_row_order(graph_t *g) {
   const int *partition_sizes;
   partition_sizes = graph_get_partition_sizes(g);
-  int atM = partition_sizes[0]>partition_sizes[1]?1:0;
+  const int k = graph_get_num_partitions(g);
   int atL = partition_sizes[0]>=partition_sizes[1]?0:1;
-  int *neighbors = NULL, *neigh_size = xmalloc(sizeof(int));
-  for(int i = 0; i < partition_sizes[atL]; i++) {
-    neighbors = graph_get_neighbors(g, atL, i, atM, neigh_size);
-    for(int j = 0; j < *neigh_size; j++) {
-      fprintf(pgbdd_var_f, "%d \n", get_variableID(g, atL,i,atM,neighbors[j]));
-      if (aux_var_map1[get_variableID(g, atL,i,atM,neighbors[j])] > 0) fprintf(pgbdd_var_f, "%d \n", aux_var_map1[get_variableID(g, atL,i,atM,neighbors[j])]);
-      //      if (sinz_var_map2[get_variableID(g, atL,i,atM,neighbors[j])] > 0) fprintf(pgbdd_var_f, "%d \n", sinz_var_map2[get_variableID(g, atL,i,atM,neighbors[j])]);
+  int atM = 1 - atL;
+  for (int a = 0; a < k; a++) {
+    for (int b = a + 1; b < k; b++) {
+      // Bipartite graphs take rows of the at least one partition
+      if (k == 2) {
+        generate_pgbdd_rows(g, atL, atM);
+      } else {
+        generate_pgbdd_rows(g, a, b);
+      }
     }
-    free(neighbors);
   }
-  
-  // Fill in remaining edges
-  for(int i = 0;i < partition_sizes[atL]; i++) {
-    for(int j = 0;j < partition_sizes[atM]; j++) {
-      if (!graph_is_edge_between(g, atL, i, atM, j)) {
-        fprintf(pgbdd_var_f, "%d \n", get_variableID(g,atL,i,atM,j));
-      }
+}
+
+/** @brief Writes the random graph formula of each seed in a range, as
+ *         FNAMES<seed>.cnf, or with {seed} of FNAME filled in if it has one.
+ *
+ *  One graph, formula and output buffer serve all seeds: the graph is
+ *  cleared and refilled in place (see generate_random_graph_into()), the
+ *  formula is cleared, and the writer moves from file to file.
+ *
+ *  @param gv       Graph variables of the random graphs.
+ *  @param g        A pointer to a graph of their sizes.
+ *  @param en       The translation encoding type.
+ *  @param atMost1  At most 1 constraints.
+ *  @param atLeast1 At least 1 constraints.
+ *  @param atMSize  Size of atMost1.
+ *  @param atLSize  Size of atLeast1.
+ *  @param fvalue   The base filename, with fields other than {seed} filled in.
+ *  @param first    The first seed.
+ *  @param last     The last seed.
+ */
+static void write_seed_range(graph_var_t *gv, graph_t *g, char *en,
+    constraint_t *atMost1, constraint_t *atLeast1, int atMSize, int atLSize,
+    const char *fvalue, int first, int last) {
+  cnf_t *cnf = cnf_create(0);
+  writer_t *w = writer_create(stdout);
+  // Without a {seed} field, the seed follows the name
+  const bool templated = strstr(fvalue, "{seed}") != NULL;
+  char *tmpl = (templated) ? path_concat(fvalue, "") : path_concat(fvalue, "S{seed}");
+  for (int seed = first; seed <= last; seed++) {
+    generate_random_graph_into(gv, seed, g);
+    rand_seed = seed;
+    cnf_clear(cnf);
+    fill_cnf_from_graph(cnf, g, en, atMost1, atLeast1, atMSize, atLSize);
+
+    char *name = replace_int_field(path_concat(tmpl, ""), "{seed}", seed);
+    char *base = output_base(name);
+    char *path = path_concat(base, ".cnf");
+    FILE *f = open_output(path);
+    writer_set_file(w, f);
+    cnf_write_dimacs_with(cnf, w);
+    fclose(f);
+    xfree(name);
+    xfree(base);
+    xfree(path);
+  }
+
+  writer_set_file(w, stdout);
+  writer_free(w);
+  xfree(tmpl);
+  cnf_free(cnf);
+}
+
+/** @brief Writes instances a number of random edge flips away from the
+ *         graph, as FNAMEFlip<i>.cnf for i in 1..N.
+ *
+ *  Each instance flips edges of the graph in place (see perturb.c), keeping
+ *  every node with at least one neighbor, writes its formula, and undoes
+ *  the flips, so all instances share the one base graph. The flips are
+ *  seeded by -s.
+ *
+ *  @param g        A pointer to the base graph.
+ *  @param en       The translation encoding type.
+ *  @param atMost1  At most 1 constraints.
+ *  @param atLeast1 At least 1 constraints.
+ *  @param atMSize  Size of atMost1.
+ *  @param atLSize  Size of atLeast1.
+ *  @param fvalue   The base filename.
+ */
+static void write_perturbed_instances(graph_t *g, char *en,
+    constraint_t *atMost1, constraint_t *atLeast1, int atMSize, int atLSize,
+    const char *fvalue) {
+  perturb_t *p = perturb_create(g, 0, 1, 1, rand_seed);
+  const size_t name_len = strlen(fvalue) + 32;
+  char *name = xmalloc(name_len);
+  for (int k = 1; k <= perturb_instances; k++) {
+    const int flips = perturb_apply(p, perturb_flips);
+    if (flips < perturb_flips) {
+      printf("Instance %d has only %d edge flips\n", k, flips);
     }
+    cnf_t *cnf = generate_cnf_from_graph(g, en, atMost1, atLeast1, atMSize, atLSize);
+    perturb_undo(p);
+
+    snprintf(name, name_len, "%sFlip%d.cnf", fvalue, k);
+    FILE *f = open_output(name);
+    cnf_write_dimacs(cnf, f);
+    fclose(f);
+    cnf_free(cnf);
   }
-  fclose(pgbdd_var_f);
+
+  xfree(name);
+  perturb_free(p);
 }
 
-void write_pgbdd_bucket(graph_t *g) {
+/** @brief Builds the bucket permutation (-p) and completes the chain order.
+ *
+ *  Edges in no AMO constraint (e.g. of a node with one neighbor) follow
+ *  the chains, then the variables of non-edges.
+ *
+ *  @param g  A pointer to the graph structure.
+ */
+static void generate_pgbdd_bucket(graph_t *g) {
   const int *partition_sizes;
   partition_sizes = graph_get_partition_sizes(g);
-  int atM = partition_sizes[0]>partition_sizes[1]?1:0;
   int atL = partition_sizes[0]>=partition_sizes[1]?0:1;
-  int *neighbors = NULL, *neigh_size = xmalloc(sizeof(int));
+  int atM = 1 - atL;
+  int base, stride;
   for(int i = 0; i < partition_sizes[atL]; i++) {
-    neighbors = graph_get_neighbors(g, atL, i, atM, neigh_size);
-    for(int j = 0; j < *neigh_size; j++) {
-      fprintf(pgbdd_bucket_f, "%d \n", get_variableID(g, atL,i,atM,neighbors[j]));
+    get_variable_row(g, atL, i, atM, &base, &stride);
+    for(int j = graph_get_next_neighbor(g, atL, i, atM, 0); j >= 0;
+        j = graph_get_next_neighbor(g, atL, i, atM, j + 1)) {
+      order_append(&pgbdd_bucket_order, base + j * stride);
     }
-    if (i > 0) {
-      for(int j = 0; j < *neigh_size; j++) {
-        if (aux_var_map1[get_variableID(g, atL,i,atM,neighbors[j])] > 0) fprintf(pgbdd_bucket_f, "%d \n", aux_var_map1[get_variableID(g, atL,i,atM,neighbors[j])]);
-      }
+    // (The first node's edges start the chains of the other partition, so
+    //   only -M chains place auxiliary variables before them)
+    for(int j = graph_get_next_neighbor(g, atL, i, atM, 0); j >= 0;
+        j = graph_get_next_neighbor(g, atL, i, atM, j + 1)) {
+      const int var = base + j * stride;
+      aux_entry_t *e = aux_map_get(&aux_map, var, false);
+      if (e != NULL) order_append_aux(&pgbdd_bucket_order, e->before);
     }
-    free(neighbors);
   }
   
-  // Fill in remaining edges/*
+  for(int i = 0; i < partition_sizes[atL]; i++) {
+    get_variable_row(g, atL, i, atM, &base, &stride);
+    for(int j = graph_get_next_neighbor(g, atL, i, atM, 0); j >= 0;
+        j = graph_get_next_neighbor(g, atL, i, atM, j + 1)) {
+      order_place_edge(base + j * stride);
+    }
+  }
+  
+  // Fill in remaining edges
   for(int i = 0;i < partition_sizes[atL]; i++) {
-    for(int j = 0;j < partition_sizes[atM]; j++) {
-      if (!graph_is_edge_between(g, atL, i, atM, j)) {
-        fprintf(pgbdd_var_f, "%d \n", get_variableID(g,atL,i,atM,j));
-        fprintf(pgbdd_bucket_f, "%d \n", get_variableID(g,atL,i,atM,j));
+    get_variable_row(g, atL, i, atM, &base, &stride);
+    for(int j = graph_get_next_non_neighbor(g, atL, i, atM, 0); j >= 0;
+        j = graph_get_next_non_neighbor(g, atL, i, atM, j + 1)) {
+      order_append(&pgbdd_chain_order, base + j * stride);
+      order_append(&pgbdd_bucket_order, base + j * stride);
+    }
+  }
+}
+
+
+/** @brief Parses grid dimensions of the form 6x8 or 4x4x4.
+ *
+ *  @param arg        The argument to -d.
+ *  @param dims[out]  The number of dimensions.
+ *  @return           The size of each dimension.
+ */
+static int *parse_grid_dims(const char *arg, int *dims) {
+  int *sizes = xmalloc(sizeof(int) * (strlen(arg) + 1));
+  *dims = 0;
+  const char *p = arg;
+  while (true) {
+    char *end;
+    long size = strtol(p, &end, 10);
+    if (end == p || size < 1) {
+      fprintf(stderr, "Grid dimensions -d must look like 6x8 or 4x4x4\n");
+      exit(-1);
+    }
+    sizes[(*dims)++] = (int) size;
+    if (*end == '\0') break;
+    if (*end != 'x') {
+      fprintf(stderr, "Grid dimensions -d must look like 6x8 or 4x4x4\n");
+      exit(-1);
+    }
+    p = end + 1;
+  }
+  return sizes;
+}
+
+/** @brief Removes the cells listed as 0,0:5,7 (one coordinate per dimension).
+ *
+ *  @param grid  A pointer to the grid.
+ *  @param arg   The argument to -r.
+ */
+static void remove_grid_cells(grid_t *grid, const char *arg) {
+  const int dims = grid_get_dims(grid);
+  int *coords = xmalloc(sizeof(int) * dims);
+  const char *p = arg;
+  while (true) {
+    for (int i = 0; i < dims; i++) {
+      char *end;
+      coords[i] = (int) strtol(p, &end, 10);
+      const char sep = (i + 1 < dims) ? ',' : ':';
+      if (end == p || (*end != sep && !(i + 1 == dims && *end == '\0'))) {
+        fprintf(stderr, "Removed cells -r must have %d coordinates each, like 0,0:5,7\n", dims);
+        exit(-1);
       }
+      p = end + (*end != '\0');
     }
+    grid_remove_cell(grid, coords);
+    if (*p == '\0') break;
   }
-  fclose(pgbdd_var_f);
-  fclose(pgbdd_bucket_f);
+  xfree(coords);
 }
 
 
@@ -544,31 +1479,57 @@ int main(int argc, char *argv[]) {
   
   FILE *f = NULL;
   mchess_t *mc = NULL;
+  grid_t *grid = NULL;
   pigeon_t *pigeon = NULL;
+  coloring_t *coloring = NULL;
   graph_var_t *gt = NULL;
   graph_t *g = NULL;
   char *gvalue = NULL, *fvalue = NULL, *evalue ="direct";
+  char *dvalue = NULL, *rvalue = NULL;
   const int *partition_sizes;
   int nvalue=4; // Default evalue to direct encoding, nvalue to 4
-  int *atMost, *atLeast, atM, atL, atLSize = 1, atMSize = 1;
+  constraint_t atMost[2], atLeast[2];
+  int atM, atL, atLSize = 1, atMSize = 1;
   bool atMFlag = false, atLFlag = false;
+  bool blocking_prob_flag = false;
   int cardinality = 1;
   float density = 1.0;
   int nedges = 0;
+  int degree = 0; // unset
+  double exponent = 2.5;
+  spanning_t spanning = SPAN_TREE;
+  bool seed_range = false;
+  int first_seed = 0, last_seed = 0;
   
   
   
   // Parse command line arguments
   extern char *optarg;
   char opt;
-  while ((opt = getopt(argc, argv, "vhLMopb:c:D:e:f:g:n:s:E:")) != -1) {
+  while ((opt = getopt(argc, argv, "vhILMopTA:b:c:d:D:e:f:g:k:n:r:s:S:x:B:E:F:H:K:N:O:P:R:")) != -1) {
     switch (opt) {
+      case 'A':
+        lex_leader_cap = atoi(optarg);
+        break;
       case 'b':
         blocked_clause_size = atoi(optarg);
         break;
+      case 'B':
+        if (strcmp(optarg,"tree")==0) spanning = SPAN_TREE;
+        else if (strcmp(optarg,"none")==0) spanning = SPAN_NONE;
+        else if (strcmp(optarg,"ust")==0) spanning = SPAN_UST;
+        else if (strcmp(optarg,"matching")==0) spanning = SPAN_MATCHING;
+        else {
+          fprintf(stderr, "Unrecognized base structure, try tree, none, ust, or matching\n");
+          exit(-1);
+        }
+        break;
       case 'c':
         cardinality = (int) strtol(optarg, (char **)NULL, 10);
         break;
+      case 'd':
+        dvalue = optarg;
+        break;
       case 'D':
         density = atof(optarg);
         break;
@@ -578,12 +1539,28 @@ int main(int argc, char *argv[]) {
       case 'f':
         fvalue = optarg;
         break;
+      case 'F':
+        perturb_flips = (int) strtol(optarg, (char **)NULL, 10);
+        break;
       case 'g':
         gvalue = optarg;
         break;
       case 'h':
         print_help(argv[0]);
         exit(0);
+      case 'H':
+        shard_levels = (int) strtol(optarg, (char **)NULL, 10);
+        if (shard_levels < 0) {
+          fprintf(stderr, "Shard levels -H must be at least 0\n");
+          exit(-1);
+        }
+        break;
+      case 'I':
+        section_index = true;
+        break;
+      case 'k':
+        degree = (int) strtol(optarg, (char **)NULL, 10);
+        break;
       case 'L':
         atLFlag = true;
         break;
@@ -593,21 +1570,59 @@ int main(int argc, char *argv[]) {
       case 'n':
         nvalue = (int) strtol(optarg, (char **)NULL, 10);
         break;
+      case 'N':
+        perturb_instances = (int) strtol(optarg, (char **)NULL, 10);
+        break;
+      case 'r':
+        rvalue = optarg;
+        break;
+      case 'R':
+        if (sscanf(optarg, "%d:%d", &first_seed, &last_seed) != 2 || first_seed > last_seed) {
+          fprintf(stderr, "Seed range -R must be first:last\n");
+          exit(-1);
+        }
+        seed_range = true;
+        break;
       case 's':
         rand_seed = (int) strtol(optarg, (char **)NULL, 10);
         break;
+      case 'S':
+        scramble = true;
+        scramble_seed = (int) strtol(optarg, (char **)NULL, 10);
+        break;
+      case 'K':
+        blocking_replicas = (int) strtol(optarg, (char **)NULL, 10);
+        break;
+      case 'P':
+        blocking_prob = atof(optarg);
+        blocking_prob_flag = true;
+        break;
       case 'E':
         nedges = (int) strtol(optarg, (char **)NULL, 10);
         break;
       case 'p':
         pgbdd_bucket = true;
         break;
+      case 'O':
+        order_heuristic = optarg;
+        if (strcmp(optarg,"rcm") != 0 && strcmp(optarg,"minfill") != 0 &&
+            strcmp(optarg,"sift") != 0) {
+          fprintf(stderr, "Unrecognized order heuristic, try rcm, minfill, or sift\n");
+          exit(-1);
+        }
+        break;
       case 'o':
         pgbdd_var_ord = true;
         break;
+      case 'T':
+        schedule = true;
+        break;
       case 'v':
         verbosity_level = 1;;
         break;
+      case 'x':
+        exponent = atof(optarg);
+        break;
       default:
         fprintf(stderr, "Unrecognized option, exiting\n");
         exit(-1);
@@ -618,28 +1633,120 @@ int main(int argc, char *argv[]) {
     printf("Program requires filename -f and graph generator -g options\n");
     exit(-1);
   }
-  if (pgbdd_bucket && pgbdd_var_ord) {
-    printf("Cannot run bucket permutation and variable ordering simultaneously\n");
+  pgbdd_ordering = pgbdd_bucket || pgbdd_var_ord || order_heuristic != NULL || schedule;
+  if (blocking_replicas > 0 && blocked_clause_size < 2) {
+    printf("Blocked clause replicas -K require blocked clauses -b of size at least 2\n");
+    exit(-1);
+  }
+  if (blocking_prob_flag && blocking_replicas <= 0) {
+    printf("Blocked clause fraction -P requires blocked clause replicas -K\n");
+    exit(-1);
+  }
+  if (blocking_replicas > 0 && scramble) {
+    printf("Cannot write blocked clause replicas of a scrambled formula\n");
+    exit(-1);
+  }
+  if (section_index && scramble) {
+    printf("Cannot index clause sections of a scrambled formula\n");
+    exit(-1);
+  }
+  if (lex_leader_cap > 0 && (blocked_clause_size > 0 || strcmp(gvalue,"coloring") == 0)) {
+    printf("Lex-leader clauses -A cannot be combined with blocked clauses -b or -g coloring\n");
+    exit(-1);
+  }
+  if (perturb_flips > 0 && (pgbdd_ordering || blocked_clause_size > 0 || lex_leader_cap > 0 ||
+                            scramble || section_index)) {
+    printf("Edge flips -F write formulas only, without -p, -o, -O, -T, -b, -A, -S or -I\n");
+    exit(-1);
+  }
+  if (seed_range && (strcmp(gvalue,"random") != 0 || pgbdd_ordering || blocked_clause_size > 0 ||
+                     lex_leader_cap > 0 || scramble || section_index || perturb_flips > 0)) {
+    printf("Seed range -R writes -g random formulas only, without -p, -o, -O, -T, -b, -A, -S, -I or -F\n");
+    exit(-1);
+  }
+  if (blocking_prob < 0 || blocking_prob > 1) {
+    printf("Blocking probability -P must be between 0 and 1\n");
     exit(-1);
   }
   if (nedges > 0 && density < 1.0) {
     printf("Must choose between edge count or density to bound size of random graph\n");
     exit(-1);
   }
+  if ((strcmp(gvalue,"cylinder")==0 || strcmp(gvalue,"torus")==0) &&
+      nvalue % 2 != 0) {
+    // An odd wrap joins two squares of the same color
+    printf("Cylinder and torus boards require an even size -n\n");
+    exit(-1);
+  }
   
   // Generate graph
   if (strcmp(gvalue,"chess")==0) {
     mc = mchess_create(nvalue, NORMAL);
     g = mchess_generate_graph(mc);
+  } else if (strcmp(gvalue,"cylinder")==0) {
+    // left and right edges of the board joined
+    mc = mchess_create(nvalue, CYLINDER);
+    g = mchess_generate_graph(mc);
+  } else if (strcmp(gvalue,"torus")==0) {
+    // top and bottom edges joined as well
+    mc = mchess_create(nvalue, TORUS);
+    g = mchess_generate_graph(mc);
+  } else if (strcmp(gvalue,"grid")==0) {
+    // rectangular or higher-dimensional board, n x n by default
+    int dims = 2;
+    int *sizes = (dvalue != NULL) ? parse_grid_dims(dvalue, &dims) : NULL;
+    if (sizes == NULL) {
+      sizes = xmalloc(sizeof(int) * 2);
+      sizes[0] = sizes[1] = nvalue;
+    }
+    grid = grid_create(dims, sizes);
+    if (rvalue != NULL) remove_grid_cells(grid, rvalue);
+    else grid_remove_corners(grid);
+    g = grid_generate_graph(grid);
+    xfree(sizes);
   } else if (strcmp(gvalue,"pigeon")==0) {
     // pigeon hole
     pigeon = pigeon_create(nvalue);
     g = pigeon_generate_graph(pigeon);
+  } else if (strcmp(gvalue,"fphp")==0 || strcmp(gvalue,"onto")==0) {
+    // functional pigeon hole, each pigeon in at most one hole, and onto,
+    //   each hole also filled
+    pigeon = pigeon_create(nvalue);
+    g = pigeon_generate_graph(pigeon);
+    atMFlag = true;
+    if (strcmp(gvalue,"onto")==0) atLFlag = true;
+  } else if (strcmp(gvalue,"rphp")==0) {
+    // relativized pigeon hole, 2n resting places by default
+    if (atMFlag || atLFlag || blocked_clause_size > 0 || pgbdd_bucket) {
+      printf("Relativized pigeon hole does not support -M, -L, -b or -p\n");
+      exit(-1);
+    }
+    pigeon = pigeon_create(nvalue);
+    g = pigeon_generate_relativized_graph(pigeon, (degree > 0) ? degree : 2 * nvalue);
+  } else if (strcmp(gvalue,"coloring")==0) {
+    // coloring of a random graph on n + c vertices with n colors
+    coloring = coloring_create(nvalue + cardinality, nvalue, density, nedges, rand_seed);
+    g = coloring_generate_graph(coloring);
   } else if (strcmp(gvalue,"random")==0) {
     // random graph with user defined parameters
     gt = graph_var_create(nvalue,cardinality,density,nedges);
+    graph_var_set_spanning(gt, spanning);
     g = generate_random_graph(gt,rand_seed);
     randomGr = true;
+  } else if (strcmp(gvalue,"regular")==0 || strcmp(gvalue,"powerlaw")==0 ||
+             strcmp(gvalue,"planted")==0) {
+    // structured random graphs, sized like random graphs
+    gt = graph_var_create(nvalue,cardinality,density,nedges);
+    graph_var_set_degree(gt, (degree > 0) ? degree : 3);
+    if (strcmp(gvalue,"regular")==0) {
+      g = generate_regular_graph(gt,rand_seed);
+    } else if (strcmp(gvalue,"powerlaw")==0) {
+      graph_var_set_exponent(gt, exponent);
+      g = generate_power_law_graph(gt,rand_seed);
+    } else {
+      g = generate_planted_graph(gt,rand_seed);
+    }
+    randomGr = true;
   } else {
     fprintf(stderr, "Unrecognized problem variant, try again\n");
     return 0;
@@ -651,58 +1758,187 @@ int main(int argc, char *argv[]) {
   atM = partition_sizes[0]>partition_sizes[1]?1:0;
   atL = partition_sizes[0]>=partition_sizes[1]?0:1;
   
+  // (with equal sizes both are partition 0)
+  atMost[0] = (constraint_t) { atM, 1 - atM, -1, NULL, NULL, 0 };
+  atLeast[0] = (constraint_t) { atL, 1 - atL, -1, NULL, NULL, 0 };
   if (atMFlag) { // atmost constraint for other partition
-    atMost = xmalloc(sizeof(int)*2);
-    atMost[1] =atL;
+    atMost[1] = (constraint_t) { atL, 1 - atL, -1, NULL, NULL, 0 };
     atMSize = 2;
   }
-  else atMost = xmalloc(sizeof(int));
   if (atLFlag) { // atleast constraint for other partition
-    atLeast = xmalloc(sizeof(int)*2);
-    atLeast[1] = atM;
+    atLeast[1] = (constraint_t) { atM, 1 - atM, -1, NULL, NULL, 0 };
     atLSize = 2;
   }
-  else atLeast = xmalloc(sizeof(int));
   
-  atMost[0] = atM;
-  atLeast[0] = atL;
+  int *clique_sizes = NULL;
+  const int **cliques = NULL;
+  if (coloring != NULL) {
+    // A color is used at most once in each clique of the cover; every
+    //   edge lies in some clique, so adjacent vertices differ
+    const int num_cliques = coloring_get_num_cliques(coloring);
+    cliques = xmalloc(sizeof(int *) * (num_cliques + 1));
+    clique_sizes = xmalloc(sizeof(int) * (num_cliques + 1));
+    for (int i = 0; i < num_cliques; i++) {
+      cliques[i] = coloring_get_clique(coloring, i, &clique_sizes[i]);
+    }
+    // Vertices get at least one color, whichever partition is larger
+    atLeast[0] = (constraint_t) { 0, 1, -1, NULL, NULL, 0 };
+    atMost[0] = (constraint_t) { 1, 0, -1, cliques, clique_sizes, num_cliques };
+    if (atMFlag) { // at most one color per vertex
+      atMost[1] = (constraint_t) { 0, 1, -1, NULL, NULL, 0 };
+    }
+    if (atLFlag) { // every color used
+      atLeast[1] = (constraint_t) { 1, 0, -1, NULL, NULL, 0 };
+    }
+  } else if (graph_get_num_partitions(g) == 3) {
+    // Pigeons rest in at least one place, each place holds at most one,
+    //   an occupied place maps to at least one hole, each hole holds at
+    //   most one occupied place
+    atLeast[0] = (constraint_t) { 0, 1, -1, NULL, NULL, 0 };
+    atLeast[1] = (constraint_t) { 1, 2, 0, NULL, NULL, 0 };
+    atMost[0] = (constraint_t) { 1, 0, -1, NULL, NULL, 0 };
+    atMost[1] = (constraint_t) { 2, 1, 0, NULL, NULL, 0 };
+    atLSize = atMSize = 2;
+  }
+  
+  // Fill in the name template, the seed last as -R fills in its own
+  char *name = replace_field(fvalue, "{g}", gvalue);
+  char *expanded = replace_field(name, "{e}", evalue);
+  xfree(name);
+  expanded = replace_int_field(expanded, "{n}", nvalue);
+  expanded = replace_int_field(expanded, "{c}", cardinality);
+  if (seed_range) {
+    write_seed_range(gt, g, evalue, atMost, atLeast, atMSize, atLSize, expanded, first_seed, last_seed);
+    xfree(expanded);
+    graph_var_free(gt);
+    graph_free(g);
+    return 0;
+  }
+  expanded = replace_int_field(expanded, "{seed}", rand_seed);
+  fvalue = output_base(expanded);
+  xfree(expanded);
+  
+  char *cnf_name = path_concat(fvalue, ".cnf");
+  char *buck_name = path_concat(fvalue, "_bucket.order");
+  char *ord_name = path_concat(fvalue, "_variable.order");
+  // With both -p and -o, the row order needs its own file
+  char *row_name = path_concat(fvalue, (pgbdd_bucket) ? "_ord_variable.order" : "_variable.order");
+  char *opt_name = path_concat(fvalue, "_opt_variable.order");
+  char *sec_name = path_concat(fvalue, ".sections");
+  char *sched_name = path_concat(fvalue, ".schedule");
+  // initialize PGBDD variable and bucket ordering data structures
+  if (pgbdd_ordering) {
+    int num_edges = 0;
+    for (int a = 0; a < graph_get_num_partitions(g); a++) {
+      for (int b = a + 1; b < graph_get_num_partitions(g); b++) {
+        for (int i = 0; i < partition_sizes[a]; i++) num_edges += graph_get_num_neighbors(g,a,i,b);
+      }
+    }
+    aux_map_init(&aux_map, num_edges);
+  }
   
-  char cnf_name[100];
-  strcpy(cnf_name,fvalue);
-  strcat(cnf_name,".cnf");
-  f = fopen(cnf_name, "w+");
-  // initialize PGBDD variable and bucket ordering files and data structures
+  // Generate CNF formula of graph g with encoding opt evalue
+  cnf_t *cnf = generate_cnf_from_graph(g, evalue, atMost, atLeast, atMSize, atLSize);
+  if (pgbdd_bucket) generate_pgbdd_bucket(g);
   if (pgbdd_bucket) {
-    char buck_name[100];
-    strcpy(buck_name,fvalue);
-    strcat(buck_name,"_bucket.order");
-    pgbdd_bucket_f = fopen(buck_name, "w+");
+    // Auxiliary variables beyond the aux map slots
+    order_complete(&pgbdd_chain_order, cnf_get_num_vars(cnf));
+    order_complete(&pgbdd_bucket_order, cnf_get_num_vars(cnf));
   }
-  if (pgbdd_var_ord || pgbdd_bucket) {
-    char ord_name[100];
-    strcpy(ord_name,fvalue);
-    strcat(ord_name,"_variable.order");
-    pgbdd_var_f  = fopen(ord_name, "w+");
-    aux_var_map1 = xmalloc(sizeof(int) * (partition_sizes[0]*partition_sizes[1])+1);
-    aux_var_map2 = xmalloc(sizeof(int) * (partition_sizes[0]*partition_sizes[1])+1);
-    for (int i = 0; i < (partition_sizes[0]*partition_sizes[1]+1); i++){
-      aux_var_map1[i] = 0;
-      aux_var_map2[i] = 0;
+  if (pgbdd_var_ord || order_heuristic != NULL || (schedule && !pgbdd_bucket)) {
+    generate_pgbdd_row_order(g);
+    order_complete(&pgbdd_row_order, cnf_get_num_vars(cnf));
+  }
+  
+  // Optimized order, refined by sifting; "sift" starts from the row order
+  order_t opt_order = { NULL, 0, 0 };
+  if (order_heuristic != NULL) {
+    const int nvars = cnf_get_num_vars(cnf);
+    int *row = ordering_from_list(pgbdd_row_order.vars, pgbdd_row_order.size, nvars);
+    long long row_cost = ordering_span_cost(cnf, row);
+    int row_width = (verbosity_level > 0) ? ordering_elimination_tree(cnf, row, NULL) : 0;
+    if (strcmp(order_heuristic,"rcm")==0) {
+      opt_order.vars = ordering_rcm(cnf);
+      xfree(row);
+    } else if (strcmp(order_heuristic,"minfill")==0) {
+      opt_order.vars = ordering_min_fill(cnf);
+      xfree(row);
+    } else {
+      opt_order.vars = row;
+    }
+    long long opt_cost = ordering_sift(cnf, opt_order.vars, SIFT_WINDOW, SIFT_PASSES);
+    opt_order.size = opt_order.cap = nvars;
+    if (verbosity_level > 0) {
+      int opt_width = ordering_elimination_tree(cnf, opt_order.vars, NULL);
+      printf("Order clause-span cost: row %lld, %s %lld\n", row_cost, order_heuristic, opt_cost);
+      printf("Order induced width: row %d, %s %d\n", row_width, order_heuristic, opt_width);
     }
   }
   
-  // Write CNF formula of graph g to file f with encoding opt evalue
-  write_cnf_from_graph(g, f, evalue, atMost, atLeast, atMSize, atLSize);
+  // Scramble names and polarities with one map, shared with the order files
+  int *var_map = NULL;
+  if (scramble) {
+    rng_t r;
+    rng_seed(&r, scramble_seed);
+    var_map = cnf_random_var_map(cnf_get_num_vars(cnf), &r, true, 0.5);
+    cnf_apply_var_map(cnf, var_map);
+    cnf_shuffle_lits(cnf, &r, 1.0);
+    cnf_shuffle_clauses(cnf, &r);
+  }
   
+  f = open_output(cnf_name);
+  cnf_write_dimacs(cnf, f);
   fclose(f);
-  if (pgbdd_bucket) write_pgbdd_bucket(g);
-  if (pgbdd_var_ord) write_pgbdd_var_ord(g);
+  if (section_index) {
+    f = open_output(sec_name);
+    cnf_write_sections(cnf, f);
+    fclose(f);
+  }
+  if (blocking_replicas > 0) write_blocking_replicas(cnf, fvalue);
+  if (perturb_flips > 0) {
+    write_perturbed_instances(g, evalue, atMost, atLeast, atMSize, atLSize, fvalue);
+  }
+  
+  // Schedule the variable order written last: optimized, chain, then row
+  if (schedule) {
+    order_t *o = (order_heuristic != NULL) ? &opt_order
+        : (pgbdd_bucket) ? &pgbdd_chain_order : &pgbdd_row_order;
+    int *vars = xmalloc(sizeof(int) * (o->size + 1));
+    for (int i = 0; i < o->size; i++) {
+      vars[i] = (var_map != NULL) ? abs(var_map[o->vars[i]]) : o->vars[i];
+    }
+    int *sched = ordering_from_list(vars, o->size, cnf_get_num_vars(cnf));
+    int width = write_schedule(cnf, sched, sched_name);
+    if (verbosity_level > 0) {
+      printf("Schedule induced width: %d\n", width);
+    }
+    xfree(vars);
+    xfree(sched);
+  }
+  cnf_free(cnf);
+  if (pgbdd_bucket) write_order(&pgbdd_bucket_order, buck_name, var_map);
+  if (pgbdd_bucket) write_order(&pgbdd_chain_order, ord_name, var_map);
+  if (pgbdd_var_ord) write_order(&pgbdd_row_order, row_name, var_map);
+  if (order_heuristic != NULL) write_order(&opt_order, opt_name, var_map);
+  xfree(pgbdd_row_order.vars);
+  xfree(pgbdd_chain_order.vars);
+  xfree(aux_map.slots);
+  xfree(var_map);
+  xfree(cnf_name);
+  xfree(buck_name);
+  xfree(ord_name);
+  xfree(row_name);
+  xfree(opt_name);
+  xfree(sec_name);
+  xfree(sched_name);
+  xfree(fvalue);
   
   int nEdges = 0;
   // Print Graph Density
   if (verbosity_level > 0) {
     for (int i = 0; i < partition_sizes[0]; i++) nEdges += graph_get_num_neighbors(g,0,i,1);
     printf("%f\n",nEdges/(1.0*partition_sizes[0]* partition_sizes[1]));
+    printf("Connected components: %d\n", graph_count_components(g));
   }
   
   return 0;
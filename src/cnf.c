@@ -0,0 +1,602 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file cnf.c
+ *  @brief An in-memory CNF formula and output transforms on it.
+ *
+ *  Shuffling the order of clauses needs the whole formula at hand, so
+ *  formulas are kept in a compact form: one int per literal, rather than
+ *  one string per literal as in a line-based script.
+ *
+ *  The transforms below are the ones used to produce scrambled copies of
+ *  a formula for testing solver robustness:
+ *
+ *    - renaming variables by a random bijection,
+ *    - flipping the polarity of variables,
+ *    - shuffling literals within clauses,
+ *    - shuffling the order of clauses.
+ *
+ *  The first two are expressed as a single signed variable map, where
+ *  var_map[v] = +/-w means that literal v is written as +/-w. The same map
+ *  can then be applied to anything else that names variables, such as the
+ *  PGBDD order files.
+ *
+ *  Clauses may also be grouped into named sections (e.g. the at-most-one
+ *  clauses of one node). Writing the formula records the byte range of
+ *  each section, so a sidecar index can be written for tools that slice
+ *  the file without parsing it.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "cnf.h"
+#include "dimacs.h"
+#include "writer.h"
+#include "xmalloc.h"
+
+/** @brief Comments are attached to the clause index they precede. */
+typedef struct cnf_comment {
+  int pos;
+  char *text;
+} cnf_comment_t;
+
+
+/** @brief A section starts at clause index pos and runs until the next.
+ *
+ *  offset and length are the byte range of its clauses in the last file
+ *  written, or -1 and 0 if the section was not written in order.
+ */
+typedef struct cnf_section {
+  int pos;
+  char *name;
+  long long offset;
+  long long length;
+} cnf_section_t;
+
+
+/** @brief Defines a CNF formula.
+ *
+ *  num_vars:      The variable count written in the header.
+ *  lits:          All literals of all clauses, each clause terminated by 0.
+ *  num_lits:      Number of ints used in lits, including terminators.
+ *  lits_cap:      Allocated length of lits.
+ *  clauses:       Offsets into lits of the first literal of each clause.
+ *                 Shuffling clauses only permutes this array.
+ *  num_clauses:   Number of completed clauses.
+ *  clauses_cap:   Allocated length of clauses.
+ *  open:          Whether a clause has been started by cnf_add_lit() but
+ *                 not yet terminated with a 0.
+ *  comments:      Comments, in the order added, each with the index of the
+ *                 clause it is written before.
+ *  num_comments:  Number of comments.
+ *  comments_cap:  Allocated length of comments.
+ *  sections:      Named sections, in clause order.
+ *  num_sections:  Number of sections.
+ *  sections_cap:  Allocated length of sections.
+ */
+struct cnf_formula {
+  int num_vars;
+  int *lits;
+  size_t num_lits;
+  size_t lits_cap;
+  size_t *clauses;
+  int num_clauses;
+  int clauses_cap;
+  bool open;
+  cnf_comment_t *comments;
+  int num_comments;
+  int comments_cap;
+  cnf_section_t *sections;
+  int num_sections;
+  int sections_cap;
+}; // cnf_t
+
+
+/** CNF API */
+
+/** @brief Creates an empty formula.
+ *
+ *  @param num_vars  The number of variables to declare in the header.
+ *  @return          A pointer to a formula with no clauses.
+ */
+cnf_t *cnf_create(int num_vars) {
+  cnf_t *cnf = xmalloc(sizeof(cnf_t));
+  cnf->num_vars = num_vars;
+  cnf->lits_cap = 1024;
+  cnf->lits = xmalloc(cnf->lits_cap * sizeof(int));
+  cnf->num_lits = 0;
+  cnf->clauses_cap = 256;
+  cnf->clauses = xmalloc(cnf->clauses_cap * sizeof(size_t));
+  cnf->num_clauses = 0;
+  cnf->open = false;
+  cnf->comments_cap = 4;
+  cnf->comments = xmalloc(cnf->comments_cap * sizeof(cnf_comment_t));
+  cnf->num_comments = 0;
+  cnf->sections_cap = 0;
+  cnf->sections = NULL;
+  cnf->num_sections = 0;
+  return cnf;
+}
+
+
+/** @brief Reads a DIMACS file into memory.
+ *
+ *  @param path  The path of the CNF file.
+ *  @return      A pointer to a formula with the clauses and comments of
+ *               the file.
+ */
+cnf_t *cnf_read_dimacs(const char *path) {
+  dimacs_reader_t *r = dimacs_open(path);
+  cnf_t *cnf = cnf_create(dimacs_get_num_vars(r));
+
+  dimacs_item_t item;
+  while ((item = dimacs_next(r)) != DIMACS_EOF) {
+    if (item == DIMACS_COMMENT) {
+      cnf_add_comment(cnf, dimacs_get_comment(r));
+    } else {
+      int size;
+      int *lits = dimacs_get_clause(r, &size);
+      cnf_add_clause(cnf, lits, size);
+    }
+  }
+
+  dimacs_close(r);
+  return cnf;
+}
+
+
+/** @brief Frees the memory allocated for a formula.
+ *
+ *  @param cnf  A pointer to a formula.
+ */
+void cnf_free(cnf_t *cnf) {
+  for (int i = 0; i < cnf->num_comments; i++) {
+    xfree(cnf->comments[i].text);
+  }
+
+  for (int i = 0; i < cnf->num_sections; i++) {
+    xfree(cnf->sections[i].name);
+  }
+
+  xfree(cnf->sections);
+  xfree(cnf->comments);
+  xfree(cnf->clauses);
+  xfree(cnf->lits);
+  xfree(cnf);
+}
+
+
+/** @brief Removes all clauses, comments, and sections, keeping allocated
+ *         storage.
+ *
+ *  Lets one formula be reused as a buffer, e.g. for a window of clauses
+ *  or for generating several formulas in a row.
+ *
+ *  @param cnf  A pointer to a formula.
+ */
+void cnf_clear(cnf_t *cnf) {
+  for (int i = 0; i < cnf->num_comments; i++) {
+    xfree(cnf->comments[i].text);
+  }
+
+  for (int i = 0; i < cnf->num_sections; i++) {
+    xfree(cnf->sections[i].name);
+  }
+
+  cnf->num_lits = 0;
+  cnf->num_clauses = 0;
+  cnf->num_comments = 0;
+  cnf->num_sections = 0;
+  cnf->open = false;
+}
+
+
+/** @brief Returns the number of variables declared in the header.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @return     The number of variables.
+ */
+int cnf_get_num_vars(cnf_t *cnf) {
+  return cnf->num_vars;
+}
+
+
+/** @brief Returns the number of completed clauses.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @return     The number of clauses.
+ */
+int cnf_get_num_clauses(cnf_t *cnf) {
+  return cnf->num_clauses;
+}
+
+
+/** @brief Returns the literals of a clause.
+ *
+ *  Clauses are indexed in output order, so after cnf_shuffle_clauses() the
+ *  same index may name a different clause. The pointer is into the formula
+ *  and DOES NOT NEED TO BE FREED, but is invalidated by adding literals.
+ *
+ *  @param cnf        A pointer to a formula.
+ *  @param idx        The index of the clause, in [0, num_clauses).
+ *  @param size[out]  The number of literals in the clause.
+ *  @return           The literals, followed by a terminating 0.
+ */
+const int *cnf_get_clause(cnf_t *cnf, int idx, int *size) {
+  assert(0 <= idx && idx < cnf->num_clauses);
+  const int *c = cnf->lits + cnf->clauses[idx];
+  int s = 0;
+  while (c[s] != 0) {
+    s++;
+  }
+
+  *size = s;
+  return c;
+}
+
+
+/** @brief Sets the number of variables declared in the header.
+ *
+ *  Encoders that allocate auxiliary variables as they go can set the final
+ *  count once all clauses are added.
+ *
+ *  @param cnf       A pointer to a formula.
+ *  @param num_vars  The number of variables.
+ */
+void cnf_set_num_vars(cnf_t *cnf, int num_vars) {
+  cnf->num_vars = num_vars;
+}
+
+
+/** @brief Adds a literal to the current clause, or ends it on 0.
+ *
+ *  Mirrors the DIMACS convention, so "1 -2 0" is added as three calls.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @param lit  A non-zero literal, or 0 to terminate the clause.
+ */
+void cnf_add_lit(cnf_t *cnf, int lit) {
+  if (cnf->num_lits == cnf->lits_cap) {
+    cnf->lits_cap *= 2;
+    cnf->lits = xrealloc(cnf->lits, cnf->lits_cap * sizeof(int));
+  }
+
+  if (!cnf->open) {
+    if (cnf->num_clauses == cnf->clauses_cap) {
+      cnf->clauses_cap *= 2;
+      cnf->clauses = xrealloc(cnf->clauses,
+          cnf->clauses_cap * sizeof(size_t));
+    }
+    cnf->clauses[cnf->num_clauses] = cnf->num_lits;
+    cnf->open = true;
+  }
+
+  cnf->lits[cnf->num_lits++] = lit;
+  if (lit == 0) {
+    cnf->num_clauses++;
+    cnf->open = false;
+  }
+}
+
+
+/** @brief Adds a complete clause.
+ *
+ *  @param cnf   A pointer to a formula.
+ *  @param lits  The literals of the clause, without a terminating 0.
+ *  @param size  The number of literals.
+ */
+void cnf_add_clause(cnf_t *cnf, const int *lits, int size) {
+  assert(!cnf->open);
+  for (int i = 0; i < size; i++) {
+    cnf_add_lit(cnf, lits[i]);
+  }
+  cnf_add_lit(cnf, 0);
+}
+
+
+/** @brief Adds a comment line before the next clause to be added.
+ *
+ *  @param cnf      A pointer to a formula.
+ *  @param comment  The text of the comment, without the leading "c ".
+ */
+void cnf_add_comment(cnf_t *cnf, const char *comment) {
+  assert(!cnf->open);
+  if (cnf->num_comments == cnf->comments_cap) {
+    cnf->comments_cap *= 2;
+    cnf->comments = xrealloc(cnf->comments,
+        cnf->comments_cap * sizeof(cnf_comment_t));
+  }
+
+  cnf_comment_t *c = &cnf->comments[cnf->num_comments++];
+  c->pos = cnf->num_clauses;
+  c->text = xmalloc(strlen(comment) + 1);
+  strcpy(c->text, comment);
+}
+
+
+/** @brief Starts a named section at the next clause to be added.
+ *
+ *  The section holds every clause added until the next section starts.
+ *  Sections do not appear in the DIMACS output; see cnf_write_sections().
+ *
+ *  @param cnf   A pointer to a formula.
+ *  @param name  The name of the section, e.g. "amo 1 4 sinz".
+ */
+void cnf_begin_section(cnf_t *cnf, const char *name) {
+  assert(!cnf->open);
+  if (cnf->num_sections == cnf->sections_cap) {
+    cnf->sections_cap = (cnf->sections_cap == 0) ? 16 : 2 * cnf->sections_cap;
+    cnf->sections = xrealloc(cnf->sections,
+        cnf->sections_cap * sizeof(cnf_section_t));
+  }
+
+  cnf_section_t *sec = &cnf->sections[cnf->num_sections++];
+  sec->pos = cnf->num_clauses;
+  sec->name = xmalloc(strlen(name) + 1);
+  strcpy(sec->name, name);
+  sec->offset = -1;
+  sec->length = 0;
+}
+
+
+/** @brief Writes the formula to a file in DIMACS format.
+ *
+ *  The header is followed by the clauses in their current order, with each
+ *  comment written just before the clause index it was added at.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @param f    An open file.
+ */
+void cnf_write_dimacs(cnf_t *cnf, FILE *f) {
+  cnf_write_dimacs_subset(cnf, f, cnf->num_clauses, NULL, 0);
+}
+
+
+/** @brief Writes a prefix of the formula plus selected later clauses
+ *         through a writer, see cnf_write_dimacs_subset().
+ */
+static void write_subset(cnf_t *cnf, writer_t *w,
+    int prefix, const int *extra, int num_extra) {
+  assert(0 <= prefix && prefix <= cnf->num_clauses);
+  writer_write_str(w, "p cnf ");
+  writer_write_int(w, cnf->num_vars);
+  writer_write_char(w, ' ');
+  writer_write_int(w, prefix + num_extra);
+  writer_write_char(w, '\n');
+
+  for (int i = 0; i < cnf->num_sections; i++) {
+    cnf->sections[i].offset = -1;
+    cnf->sections[i].length = 0;
+  }
+
+  int c = 0, s = 0;
+  cnf_section_t *sec = NULL;
+  for (int i = 0; i <= prefix; i++) {
+    while (c < cnf->num_comments && cnf->comments[c].pos == i) {
+      writer_write_str(w, "c ");
+      writer_write_str(w, cnf->comments[c].text);
+      writer_write_char(w, '\n');
+      c++;
+    }
+
+    if (i < prefix) {
+      while (s < cnf->num_sections && cnf->sections[s].pos == i) {
+        sec = &cnf->sections[s++];
+        sec->offset = writer_get_offset(w);
+      }
+
+      int size;
+      const int *lits = cnf_get_clause(cnf, i, &size);
+      writer_write_clause(w, lits, size);
+      if (sec != NULL) {
+        sec->length = writer_get_offset(w) - sec->offset;
+      }
+    }
+  }
+
+  for (int i = 0; i < num_extra; i++) {
+    int size;
+    const int *lits = cnf_get_clause(cnf, extra[i], &size);
+    writer_write_clause(w, lits, size);
+  }
+}
+
+
+/** @brief Writes a prefix of the formula plus selected later clauses.
+ *
+ *  Clauses [0, prefix) are written in order, with their comments, as are
+ *  comments attached at index prefix. Then the clauses named in extra are
+ *  written in the order given. The header counts exactly the clauses
+ *  written, so e.g. a random subset of a trailing group of clauses can be
+ *  written without copying the formula. Byte ranges are recorded only for
+ *  the sections within the prefix.
+ *
+ *  @param cnf        A pointer to a formula.
+ *  @param f          An open file.
+ *  @param prefix     Number of leading clauses to write.
+ *  @param extra      Indexes of further clauses to write, or NULL.
+ *  @param num_extra  Number of entries in extra.
+ */
+void cnf_write_dimacs_subset(cnf_t *cnf, FILE *f,
+    int prefix, const int *extra, int num_extra) {
+  writer_t *w = writer_create(f);
+  write_subset(cnf, w, prefix, extra, num_extra);
+  writer_free(w);
+}
+
+
+/** @brief Writes the formula in DIMACS format through a writer.
+ *
+ *  Like cnf_write_dimacs(), but reuses the buffer of the writer, which is
+ *  flushed at the end, e.g. when writing many formulas in a row.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @param w    A pointer to a writer on an empty file.
+ */
+void cnf_write_dimacs_with(cnf_t *cnf, writer_t *w) {
+  write_subset(cnf, w, cnf->num_clauses, NULL, 0);
+  writer_flush(w);
+}
+
+
+/** @brief Writes the index of sections recorded by the last write.
+ *
+ *  One line per section: first clause index, number of clauses, byte
+ *  offset and byte length of its clauses in the CNF file, then its name.
+ *  Comment lines between sections are not covered by any byte range.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @param f    An open file.
+ */
+void cnf_write_sections(cnf_t *cnf, FILE *f) {
+  writer_t *w = writer_create(f);
+  writer_write_str(w,
+      "c first_clause num_clauses byte_offset byte_length section\n");
+  for (int i = 0; i < cnf->num_sections; i++) {
+    cnf_section_t *sec = &cnf->sections[i];
+    int end = (i + 1 < cnf->num_sections) ?
+      cnf->sections[i + 1].pos : cnf->num_clauses;
+    writer_write_int(w, sec->pos);
+    writer_write_char(w, ' ');
+    writer_write_int(w, end - sec->pos);
+    writer_write_char(w, ' ');
+    writer_write_int(w, sec->offset);
+    writer_write_char(w, ' ');
+    writer_write_int(w, sec->length);
+    writer_write_char(w, ' ');
+    writer_write_str(w, sec->name);
+    writer_write_char(w, '\n');
+  }
+  writer_free(w);
+}
+
+
+/** Transforms */
+
+/** @brief Generates a random signed variable map.
+ *
+ *  Runs in O(num_vars). The returned array has num_vars + 1 entries, with
+ *  var_map[0] = 0, and must be freed by the caller.
+ *
+ *  @param num_vars  The number of variables to map.
+ *  @param r         A pointer to a seeded generator.
+ *  @param permute   If true, variables are renamed by a uniformly random
+ *                   bijection on [1, num_vars]. Otherwise, names are kept.
+ *  @param flip      Probability with which each variable's polarity is
+ *                   flipped. Flipping is per variable, so v and -v always
+ *                   stay complementary.
+ *  @return          The signed variable map.
+ */
+int *cnf_random_var_map(int num_vars, rng_t *r, bool permute, double flip) {
+  int *var_map = xmalloc((num_vars + 1) * sizeof(int));
+  var_map[0] = 0;
+  for (int v = 1; v <= num_vars; v++) {
+    var_map[v] = v;
+  }
+
+  if (permute) {
+    rng_shuffle(r, var_map + 1, num_vars);
+  }
+
+  if (flip > 0) {
+    for (int v = 1; v <= num_vars; v++) {
+      if (rng_double(r) < flip) {
+        var_map[v] = -var_map[v];
+      }
+    }
+  }
+
+  return var_map;
+}
+
+
+/** @brief Renames literals in place by a signed variable map.
+ *
+ *  @param lits     The literals to rename.
+ *  @param size     The number of literals.
+ *  @param var_map  A signed variable map, see cnf_random_var_map().
+ */
+void cnf_remap_lits(int *lits, size_t size, const int *var_map) {
+  for (size_t i = 0; i < size; i++) {
+    const int lit = lits[i];
+    lits[i] = (lit < 0) ? -var_map[-lit] : var_map[lit];
+  }
+}
+
+
+/** @brief Renames every literal in the formula by a signed variable map.
+ *
+ *  @param cnf      A pointer to a formula.
+ *  @param var_map  A signed variable map, see cnf_random_var_map().
+ */
+void cnf_apply_var_map(cnf_t *cnf, const int *var_map) {
+  // Terminating 0s map to themselves, so the array is mapped in one pass
+  cnf_remap_lits(cnf->lits, cnf->num_lits, var_map);
+}
+
+
+/** @brief Shuffles the literals within clauses.
+ *
+ *  @param cnf   A pointer to a formula.
+ *  @param r     A pointer to a seeded generator.
+ *  @param prob  Probability with which each clause is shuffled.
+ */
+void cnf_shuffle_lits(cnf_t *cnf, rng_t *r, double prob) {
+  for (int i = 0; i < cnf->num_clauses; i++) {
+    if (prob < 1 && rng_double(r) >= prob) {
+      continue;
+    }
+
+    int size;
+    int *lits = (int *) cnf_get_clause(cnf, i, &size);
+    rng_shuffle(r, lits, size);
+  }
+}
+
+
+/** @brief Shuffles the order of the clauses.
+ *
+ *  Only the clause offsets are permuted; literals are not moved. Comments
+ *  keep their clause indexes, so a comment that marked the start of a
+ *  group of clauses no longer does after shuffling. Sections no longer
+ *  hold contiguous clauses, so they are dropped.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @param r    A pointer to a seeded generator.
+ */
+void cnf_shuffle_clauses(cnf_t *cnf, rng_t *r) {
+  for (int i = 0; i < cnf->num_sections; i++) {
+    xfree(cnf->sections[i].name);
+  }
+  cnf->num_sections = 0;
+
+  size_t *clauses = cnf->clauses;
+  for (int i = cnf->num_clauses - 1; i > 0; i--) {
+    int j = rng_bounded(r, i + 1);
+    size_t temp = clauses[i];
+    clauses[i] = clauses[j];
+    clauses[j] = temp;
+  }
+}
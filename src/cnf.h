@@ -0,0 +1,80 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file cnf.h
+ *  @brief An in-memory CNF formula and output transforms on it.
+ *
+ *  See cnf.c for implementation details.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#ifndef _CNF_H_
+#define _CNF_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "rng.h"
+#include "writer.h"
+
+/** @brief Defines a CNF formula.
+ *
+ *  See cnf.c for struct fields and motivation.
+ */
+typedef struct cnf_formula cnf_t;
+
+
+/** CNF API */
+
+/** Creation and free functions */
+cnf_t *cnf_create(int num_vars);
+cnf_t *cnf_read_dimacs(const char *path);
+void cnf_free(cnf_t *cnf);
+void cnf_clear(cnf_t *cnf);
+
+/** Getters */
+int cnf_get_num_vars(cnf_t *cnf);
+int cnf_get_num_clauses(cnf_t *cnf);
+const int *cnf_get_clause(cnf_t *cnf, int idx, int *size);
+
+/** Modification functions */
+void cnf_set_num_vars(cnf_t *cnf, int num_vars);
+void cnf_add_lit(cnf_t *cnf, int lit);
+void cnf_add_clause(cnf_t *cnf, const int *lits, int size);
+void cnf_add_comment(cnf_t *cnf, const char *comment);
+void cnf_begin_section(cnf_t *cnf, const char *name);
+
+/** Output */
+void cnf_write_dimacs(cnf_t *cnf, FILE *f);
+void cnf_write_dimacs_with(cnf_t *cnf, writer_t *w);
+void cnf_write_dimacs_subset(cnf_t *cnf, FILE *f,
+    int prefix, const int *extra, int num_extra);
+void cnf_write_sections(cnf_t *cnf, FILE *f);
+
+/** Transforms */
+int *cnf_random_var_map(int num_vars, rng_t *r, bool permute, double flip);
+void cnf_remap_lits(int *lits, size_t size, const int *var_map);
+void cnf_apply_var_map(cnf_t *cnf, const int *var_map);
+void cnf_shuffle_lits(cnf_t *cnf, rng_t *r, double prob);
+void cnf_shuffle_clauses(cnf_t *cnf, rng_t *r);
+
+#endif /* _CNF_H_ */
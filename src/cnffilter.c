@@ -0,0 +1,329 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file cnffilter.c
+ *  @brief Streams a DIMACS CNF file through a chain of filters.
+ *
+ *  Post-processing of bipartgen output used to be done by scripts that
+ *  load the whole file. Here the input is mmap()ed and streamed, so memory
+ *  is bounded by the shuffle window and one flag per variable.
+ *
+ *  Sections are delimited by comments: section 0 holds the clauses before
+ *  the first comment, and each comment starts the next section. In
+ *  bipartgen output, section 1 is the blocked clauses from perfect
+ *  matchings. Comments are always passed through.
+ *
+ *  The filters are applied to each clause in this order:
+ *
+ *    -k sec:prob  Keep each clause of section sec with probability prob.
+ *                 May be repeated for different sections.
+ *    -C           Compact variables: renumber the variables that still
+ *                 occur to 1..n, keeping their relative order.
+ *    -w size      Shuffle clauses within windows of this many clauses.
+ *                 Windows never cross a comment, so sections stay intact.
+ *    -R           Recount the header from the clauses written.
+ *
+ *  Sampling and compaction change the header, so with -k or -C (or -R)
+ *  the input is read twice: a first pass counts the surviving clauses and
+ *  variables, and a second pass, with the generator re-seeded so that the
+ *  same clauses are kept, writes them. The second pass is over the same
+ *  mapping, so it runs at the speed of the page cache.
+ *
+ *  ///////////////////////////////////////////////////////////////////////////
+ *  // USAGE
+ *  ///////////////////////////////////////////////////////////////////////////
+ *
+ *  @usage ./cnffilter [-CR] [-k sec:prob]... [-w size] [-r seed] [-o out] <in.cnf>
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "xmalloc.h"
+#include "rng.h"
+#include "cnf.h"
+#include "dimacs.h"
+#include "writer.h"
+
+/** @brief Per-section keep probabilities, 1.0 where no -k was given. */
+static double *keep_probs = NULL;
+static int num_keep_probs = 0;
+
+/** @brief Variables occurring in a kept clause, indexed by variable. */
+static bool *var_used = NULL;
+static int var_used_cap = 0;
+
+static void print_help(char *runtime_path) {
+  printf("\n%s: BiPartGen CNF filter\n", runtime_path);
+  printf("Developed by: Joseph Reeves and Cayden Codel\n\n");
+  printf("  -C            Compact variables to 1..n, keeping their order.\n");
+  printf("  -h            Display this help message.\n");
+  printf("  -k <sec:prob> Keep clauses of comment-delimited section sec with probability prob.\n");
+  printf("  -o <name>     Output file (default stdout).\n");
+  printf("  -R            Recount the header from the clauses written.\n");
+  printf("  -r <int>      Randomization seed (default time-based).\n");
+  printf("  -w <int>      Shuffle clauses within windows of this size.\n");
+}
+
+
+/** @brief Parses a "sec:prob" argument to -k. */
+static void parse_keep_prob(const char *arg) {
+  char *end;
+  long sec = strtol(arg, &end, 10);
+  if (end == arg || *end != ':' || sec < 0) {
+    fprintf(stderr, "Sampling option -k must look like sec:prob\n");
+    exit(-1);
+  }
+
+  double prob = atof(end + 1);
+  if (prob < 0 || prob > 1) {
+    fprintf(stderr, "Sampling prob must be between 0 and 1\n");
+    exit(-1);
+  }
+
+  if (sec >= num_keep_probs) {
+    keep_probs = xrealloc(keep_probs, sizeof(double) * (sec + 1));
+    for (int i = num_keep_probs; i <= sec; i++) {
+      keep_probs[i] = 1.0;
+    }
+    num_keep_probs = sec + 1;
+  }
+  keep_probs[sec] = prob;
+}
+
+
+/** @brief Decides whether a clause in the given section is kept. */
+static bool keep_clause(rng_t *r, int section) {
+  if (section >= num_keep_probs || keep_probs[section] >= 1) {
+    return true;
+  }
+  return keep_probs[section] > 0 && rng_double(r) < keep_probs[section];
+}
+
+
+/** @brief Marks the variables of a clause as used. */
+static void mark_used(const int *lits, int size) {
+  for (int i = 0; i < size; i++) {
+    int var = abs(lits[i]);
+    if (var >= var_used_cap) {
+      int cap = (var_used_cap == 0) ? 1024 : var_used_cap;
+      while (cap <= var) {
+        cap *= 2;
+      }
+      var_used = xrealloc(var_used, sizeof(bool) * cap);
+      memset(var_used + var_used_cap, 0, sizeof(bool) * (cap - var_used_cap));
+      var_used_cap = cap;
+    }
+    var_used[var] = true;
+  }
+}
+
+
+/** @brief Writes the clauses buffered in a window, in shuffled order. */
+static void flush_window(cnf_t *window, rng_t *r, writer_t *w) {
+  cnf_shuffle_clauses(window, r);
+  const int num_clauses = cnf_get_num_clauses(window);
+  for (int i = 0; i < num_clauses; i++) {
+    int size;
+    const int *lits = cnf_get_clause(window, i, &size);
+    writer_write_clause(w, lits, size);
+  }
+  cnf_clear(window);
+}
+
+
+/** @brief Handles main execution. Parses CLI. */
+int main(int argc, char *argv[]) {
+  bool compact = false, recount = false;
+  int window_size = 0;
+  unsigned long long seed = (unsigned long long) time(NULL);
+  char *ovalue = NULL;
+
+  // Parse command line arguments
+  extern char *optarg;
+  extern int optind;
+  int opt;
+  while ((opt = getopt(argc, argv, "ChRk:o:r:w:")) != -1) {
+    switch (opt) {
+      case 'C':
+        compact = true;
+        break;
+      case 'h':
+        print_help(argv[0]);
+        exit(0);
+      case 'R':
+        recount = true;
+        break;
+      case 'k':
+        parse_keep_prob(optarg);
+        break;
+      case 'o':
+        ovalue = optarg;
+        break;
+      case 'r':
+        seed = strtoull(optarg, (char **)NULL, 10);
+        break;
+      case 'w':
+        window_size = (int) strtol(optarg, (char **)NULL, 10);
+        break;
+      default:
+        fprintf(stderr, "Unrecognized option, exiting\n");
+        exit(-1);
+    }
+  }
+
+  if (optind != argc - 1) {
+    fprintf(stderr, "Must supply exactly one CNF file\n");
+    exit(-1);
+  }
+  if (window_size < 0) {
+    fprintf(stderr, "Shuffle window must be positive\n");
+    exit(-1);
+  }
+
+  dimacs_reader_t *reader = dimacs_open(argv[optind]);
+  int num_vars = dimacs_get_num_vars(reader);
+  int num_clauses = dimacs_get_num_clauses(reader);
+
+  // Sampling and shuffling draw from separate generators, so the counting
+  //   pass (which never shuffles) makes the same sampling choices
+  rng_t sample_rng, shuffle_rng;
+  rng_seed(&sample_rng, seed);
+  rng_seed(&shuffle_rng, seed + 1);
+
+  // First pass: count what survives sampling
+  if (compact || recount || num_keep_probs > 0) {
+    int section = 0;
+    num_clauses = 0;
+    dimacs_item_t item;
+    while ((item = dimacs_next(reader)) != DIMACS_EOF) {
+      if (item == DIMACS_COMMENT) {
+        section++;
+        continue;
+      }
+      if (keep_clause(&sample_rng, section)) {
+        int size;
+        const int *lits = dimacs_get_clause(reader, &size);
+        if (compact || recount) {
+          mark_used(lits, size);
+        }
+        num_clauses++;
+      }
+    }
+
+    dimacs_rewind(reader);
+    rng_seed(&sample_rng, seed);
+  }
+
+  // Variable maps are over the used variables, as found in the first pass
+  int *var_map = NULL;
+  if (compact) {
+    var_map = xmalloc(sizeof(int) * (var_used_cap + 1));
+    int next = 0;
+    for (int v = 0; v < var_used_cap; v++) {
+      var_map[v] = (var_used[v]) ? ++next : 0;
+    }
+    num_vars = next;
+  } else if (recount) {
+    num_vars = 0;
+    for (int v = var_used_cap - 1; v > 0; v--) {
+      if (var_used[v]) {
+        num_vars = v;
+        break;
+      }
+    }
+  }
+
+  FILE *out = stdout;
+  if (ovalue != NULL) {
+    out = fopen(ovalue, "w");
+    if (out == NULL) {
+      fprintf(stderr, "Could not open output file %s\n", ovalue);
+      exit(-1);
+    }
+  }
+
+  writer_t *w = writer_create(out);
+  writer_write_str(w, "p cnf ");
+  writer_write_int(w, num_vars);
+  writer_write_char(w, ' ');
+  writer_write_int(w, num_clauses);
+  writer_write_char(w, '\n');
+
+  cnf_t *window = (window_size > 1) ? cnf_create(num_vars) : NULL;
+
+  // Second pass: filter and write
+  int section = 0;
+  dimacs_item_t item;
+  while ((item = dimacs_next(reader)) != DIMACS_EOF) {
+    if (item == DIMACS_COMMENT) {
+      if (window != NULL) {
+        flush_window(window, &shuffle_rng, w);
+      }
+      writer_write_str(w, "c ");
+      writer_write_str(w, dimacs_get_comment(reader));
+      writer_write_char(w, '\n');
+      section++;
+      continue;
+    }
+
+    if (!keep_clause(&sample_rng, section)) {
+      continue;
+    }
+
+    int size;
+    int *lits = dimacs_get_clause(reader, &size);
+    if (var_map != NULL) {
+      cnf_remap_lits(lits, size, var_map);
+    }
+
+    if (window != NULL) {
+      cnf_add_clause(window, lits, size);
+      if (cnf_get_num_clauses(window) == window_size) {
+        flush_window(window, &shuffle_rng, w);
+      }
+    } else {
+      writer_write_clause(w, lits, size);
+    }
+  }
+
+  if (window != NULL) {
+    flush_window(window, &shuffle_rng, w);
+    cnf_free(window);
+  }
+  writer_free(w);
+
+  dimacs_close(reader);
+  xfree(var_map);
+  xfree(var_used);
+  xfree(keep_probs);
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  return 0;
+}
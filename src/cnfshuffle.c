@@ -0,0 +1,198 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file cnfshuffle.c
+ *  @brief Scrambles a DIMACS CNF file: clause order, literal order,
+ *         variable names, and variable polarities.
+ *
+ *  Replaces the cnf_shuffler.py script. The input is mmap()ed and streamed
+ *  clause by clause, so unless the clause order is shuffled (-c), memory
+ *  use is bounded by the variable map, not the size of the formula. With
+ *  -c, the formula is held in memory at one int per literal.
+ *
+ *  All randomness comes from one seeded generator, so a given seed and
+ *  set of options always produce the same output.
+ *
+ *  ///////////////////////////////////////////////////////////////////////////
+ *  // USAGE
+ *  ///////////////////////////////////////////////////////////////////////////
+ *
+ *  @usage ./cnfshuffle [-cn] [-r seed] [-s prob] [-v prob] [-o out] <in.cnf>
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "xmalloc.h"
+#include "rng.h"
+#include "cnf.h"
+#include "dimacs.h"
+#include "writer.h"
+
+static void print_help(char *runtime_path) {
+  printf("\n%s: BiPartGen CNF shuffler\n", runtime_path);
+  printf("Developed by: Joseph Reeves and Cayden Codel\n\n");
+  printf("  -c            Shuffle the order of the clauses.\n");
+  printf("  -h            Display this help message.\n");
+  printf("  -n            Shuffle the names of the variables.\n");
+  printf("  -o <name>     Output file (default stdout).\n");
+  printf("  -r <int>      Randomization seed (default time-based).\n");
+  printf("  -s <float>    Flip the sign of each variable with this probability.\n");
+  printf("  -v <float>    Shuffle literals within each clause with this probability.\n");
+}
+
+
+/** @brief Handles main execution. Parses CLI. */
+int main(int argc, char *argv[]) {
+  bool shuffle_clauses = false, shuffle_names = false;
+  double sign_prob = 0.0, lit_prob = 0.0;
+  unsigned long long seed = (unsigned long long) time(NULL);
+  char *ovalue = NULL;
+
+  // Parse command line arguments
+  extern char *optarg;
+  extern int optind;
+  int opt;
+  while ((opt = getopt(argc, argv, "chno:r:s:v:")) != -1) {
+    switch (opt) {
+      case 'c':
+        shuffle_clauses = true;
+        break;
+      case 'h':
+        print_help(argv[0]);
+        exit(0);
+      case 'n':
+        shuffle_names = true;
+        break;
+      case 'o':
+        ovalue = optarg;
+        break;
+      case 'r':
+        seed = strtoull(optarg, (char **)NULL, 10);
+        break;
+      case 's':
+        sign_prob = atof(optarg);
+        break;
+      case 'v':
+        lit_prob = atof(optarg);
+        break;
+      default:
+        fprintf(stderr, "Unrecognized option, exiting\n");
+        exit(-1);
+    }
+  }
+
+  if (optind != argc - 1) {
+    fprintf(stderr, "Must supply exactly one CNF file\n");
+    exit(-1);
+  }
+  if (sign_prob < 0 || sign_prob > 1) {
+    fprintf(stderr, "Sign prob must be between 0 and 1\n");
+    exit(-1);
+  }
+  if (lit_prob < 0 || lit_prob > 1) {
+    fprintf(stderr, "Prob for literal shuffling not between 0 and 1\n");
+    exit(-1);
+  }
+
+  FILE *out = stdout;
+  if (ovalue != NULL) {
+    out = fopen(ovalue, "w");
+    if (out == NULL) {
+      fprintf(stderr, "Could not open output file %s\n", ovalue);
+      exit(-1);
+    }
+  }
+
+  rng_t r;
+  rng_seed(&r, seed);
+
+  dimacs_reader_t *reader = dimacs_open(argv[optind]);
+  const int num_vars = dimacs_get_num_vars(reader);
+  int *var_map = NULL;
+  if (shuffle_names || sign_prob > 0) {
+    var_map = cnf_random_var_map(num_vars, &r, shuffle_names, sign_prob);
+  }
+
+  // Clause order needs the whole formula; otherwise stream straight through
+  cnf_t *cnf = NULL;
+  writer_t *w = NULL;
+  if (shuffle_clauses) {
+    cnf = cnf_create(num_vars);
+  } else {
+    w = writer_create(out);
+    writer_write_str(w, "p cnf ");
+    writer_write_int(w, num_vars);
+    writer_write_char(w, ' ');
+    writer_write_int(w, dimacs_get_num_clauses(reader));
+    writer_write_char(w, '\n');
+  }
+
+  dimacs_item_t item;
+  while ((item = dimacs_next(reader)) != DIMACS_EOF) {
+    if (item == DIMACS_COMMENT) {
+      if (cnf != NULL) {
+        cnf_add_comment(cnf, dimacs_get_comment(reader));
+      } else {
+        writer_write_str(w, "c ");
+        writer_write_str(w, dimacs_get_comment(reader));
+        writer_write_char(w, '\n');
+      }
+      continue;
+    }
+
+    int size;
+    int *lits = dimacs_get_clause(reader, &size);
+    if (var_map != NULL) {
+      cnf_remap_lits(lits, size, var_map);
+    }
+    if (lit_prob > 0 && (lit_prob >= 1 || rng_double(&r) < lit_prob)) {
+      rng_shuffle(&r, lits, size);
+    }
+
+    if (cnf != NULL) {
+      cnf_add_clause(cnf, lits, size);
+    } else {
+      writer_write_clause(w, lits, size);
+    }
+  }
+
+  if (cnf != NULL) {
+    cnf_shuffle_clauses(cnf, &r);
+    cnf_write_dimacs(cnf, out);
+    cnf_free(cnf);
+  } else {
+    writer_free(w);
+  }
+
+  dimacs_close(reader);
+  xfree(var_map);
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  return 0;
+}
@@ -0,0 +1,288 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file coloring.c
+ *  @brief Instance generator for graph coloring problems.
+ *
+ *  Coloring a graph G with k colors is a bipartite problem between the
+ *  vertices of G and the colors: each vertex has at least one color, and
+ *  adjacent vertices do not share a color. The second constraint is an
+ *  "at most one" over each clique of G for each color, so G is covered by
+ *  cliques, and the AMO encodings of bipartgen are applied per clique.
+ *  Coloring the complete graph on n + 1 vertices with n colors is the
+ *  pigeonhole problem.
+ *
+ *  G is a random graph with a given density or number of edges.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h> // For uint64_t
+#include <stdbool.h>
+
+#include "coloring.h"
+#include "xmalloc.h"
+#include "rng.h"
+
+#ifndef BITS_IN_WORD
+#define BITS_IN_WORD 64
+#endif
+
+#ifndef WORD_MASK
+#define WORD_MASK    (BITS_IN_WORD - 1)
+#endif
+
+/** @brief Gets bit v of a bitvector row. */
+#define GET_BIT(row, v)  (((row)[(v) / BITS_IN_WORD] >> ((v) & WORD_MASK)) & 0x1)
+
+/** @brief Sets bit v of a bitvector row. */
+#define SET_BIT(row, v)  ((row)[(v) / BITS_IN_WORD] |= (1ULL << ((v) & WORD_MASK)))
+
+
+/** @brief Defines a graph coloring problem.
+ *
+ *  vertices:      The number of vertices of G.
+ *  colors:        The number of colors.
+ *  words:         The number of words in each adjacency row.
+ *  adj:           Adjacency bitvectors of G, one row per vertex.
+ *  cliques:       Cliques covering every edge of G, each sorted.
+ *  clique_sizes:  The number of vertices in each clique.
+ *  num_cliques:   The number of cliques.
+ */
+struct graph_coloring {
+  int vertices;
+  int colors;
+  int words;
+  uint64_t **adj;
+  int **cliques;
+  int *clique_sizes;
+  int num_cliques;
+}; // coloring_t
+
+
+/** Helper functions */
+
+/** @brief Orders ints increasingly, for qsort(). */
+static int compare_ints(const void *a, const void *b) {
+  const int x = *(const int *) a, y = *(const int *) b;
+  return (x > y) - (x < y);
+}
+
+
+/** @brief Covers the edges of G by cliques, greedily.
+ *
+ *  Each edge (u, v) not yet covered starts a clique, which grows by the
+ *  lowest common neighbor of its vertices until none is left. Every pair
+ *  in the clique is then covered. Dense graphs get few, large cliques.
+ *
+ *  @param c  A pointer to a coloring problem.
+ */
+static void cover_cliques(coloring_t *c) {
+  const int n = c->vertices;
+  const int words = c->words;
+  uint64_t **covered = xmalloc((n + 1) * sizeof(uint64_t *));
+  for (int u = 0; u < n; u++) {
+    covered[u] = xcalloc(words + 1, sizeof(uint64_t));
+  }
+  uint64_t *common = xmalloc((words + 1) * sizeof(uint64_t));
+  int *clique = xmalloc((n + 1) * sizeof(int));
+  int cap = 16;
+  c->cliques = xmalloc(cap * sizeof(int *));
+  c->clique_sizes = xmalloc(cap * sizeof(int));
+  c->num_cliques = 0;
+
+  for (int u = 0; u < n; u++) {
+    for (int v = u + 1; v < n; v++) {
+      if (!GET_BIT(c->adj[u], v) || GET_BIT(covered[u], v)) {
+        continue;
+      }
+
+      // Grow the clique from the common neighbors of its vertices
+      int size = 0;
+      clique[size++] = u;
+      clique[size++] = v;
+      for (int i = 0; i < words; i++) {
+        common[i] = c->adj[u][i] & c->adj[v][i];
+      }
+      for (int i = 0; i < words; i++) {
+        while (common[i] != 0) {
+          const int w = i * BITS_IN_WORD + __builtin_ctzll(common[i]);
+          clique[size++] = w;
+          for (int j = 0; j < words; j++) {
+            common[j] &= c->adj[w][j];
+          }
+        }
+      }
+
+      for (int a = 0; a < size; a++) {
+        for (int b = 0; b < size; b++) {
+          SET_BIT(covered[clique[a]], clique[b]);
+        }
+      }
+
+      // Keep the clique sorted, as AMO constraints follow node order
+      int *sorted = xmalloc(size * sizeof(int));
+      memcpy(sorted, clique, size * sizeof(int));
+      qsort(sorted, size, sizeof(int), compare_ints);
+
+      if (c->num_cliques == cap) {
+        cap *= 2;
+        c->cliques = xrealloc(c->cliques, cap * sizeof(int *));
+        c->clique_sizes = xrealloc(c->clique_sizes, cap * sizeof(int));
+      }
+      c->cliques[c->num_cliques] = sorted;
+      c->clique_sizes[c->num_cliques++] = size;
+    }
+  }
+
+  for (int u = 0; u < n; u++) {
+    xfree(covered[u]);
+  }
+  xfree(covered);
+  xfree(common);
+  xfree(clique);
+}
+
+
+/** Coloring API */
+
+/** @brief Creates a coloring problem on a random graph.
+ *
+ *  @param vertices  The number of vertices of G.
+ *  @param colors    The number of colors.
+ *  @param density   Probability of an edge between two vertices, if
+ *                   nedges is 0.
+ *  @param nedges    Number of edges of G, chosen uniformly, or 0.
+ *  @param seed      Random number seed.
+ *  @return          A pointer to a coloring problem.
+ */
+coloring_t *coloring_create(int vertices, int colors, float density, int nedges, int seed) {
+  if (vertices < 1 || colors < 1) {
+    fprintf(stderr, "Coloring needs at least one vertex and one color\n");
+    exit(-1);
+  }
+
+  coloring_t *c = xmalloc(sizeof(coloring_t));
+  c->vertices = vertices;
+  c->colors = colors;
+  c->words = (vertices + BITS_IN_WORD - 1) / BITS_IN_WORD;
+  c->adj = xmalloc(vertices * sizeof(uint64_t *));
+  for (int u = 0; u < vertices; u++) {
+    c->adj[u] = xcalloc(c->words + 1, sizeof(uint64_t));
+  }
+
+  rng_t r;
+  rng_seed(&r, seed);
+  const int num_pairs = vertices * (vertices - 1) / 2;
+  int *pairs = xmalloc((num_pairs + 1) * sizeof(int));
+  for (int p = 0; p < num_pairs; p++) {
+    pairs[p] = p;
+  }
+
+  // Either the first nedges of a partial shuffle, or each with density
+  int goal = num_pairs;
+  if (nedges > 0) {
+    goal = (nedges < num_pairs) ? nedges : num_pairs;
+    for (int p = 0; p < goal; p++) {
+      const int q = p + rng_bounded(&r, num_pairs - p);
+      const int tmp = pairs[p];
+      pairs[p] = pairs[q];
+      pairs[q] = tmp;
+    }
+  }
+
+  int p = 0;
+  for (int u = 0; u < vertices; u++) {
+    for (int v = u + 1; v < vertices; v++, p++) {
+      const bool keep = (nedges > 0) ? (pairs[p] < goal) : (density >= 1.0 || rng_double(&r) < density);
+      if (keep) {
+        SET_BIT(c->adj[u], v);
+        SET_BIT(c->adj[v], u);
+      }
+    }
+  }
+  xfree(pairs);
+
+  cover_cliques(c);
+  return c;
+}
+
+
+/** @brief Frees the memory allocated by a coloring problem.
+ *
+ *  @param c  A pointer to a coloring problem.
+ */
+void coloring_free(coloring_t *c) {
+  for (int u = 0; u < c->vertices; u++) {
+    xfree(c->adj[u]);
+  }
+  for (int i = 0; i < c->num_cliques; i++) {
+    xfree(c->cliques[i]);
+  }
+  xfree(c->adj);
+  xfree(c->cliques);
+  xfree(c->clique_sizes);
+  xfree(c);
+}
+
+
+/** @brief Returns 1 if vertices u and v of G are adjacent, 0 otherwise. */
+int coloring_is_edge(coloring_t *c, int u, int v) {
+  return GET_BIT(c->adj[u], v);
+}
+
+
+/** @brief Returns the number of cliques covering the edges of G. */
+int coloring_get_num_cliques(coloring_t *c) {
+  return c->num_cliques;
+}
+
+
+/** @brief Gets a clique of the cover.
+ *
+ *  @param c          A pointer to a coloring problem.
+ *  @param i          The index of the clique.
+ *  @param size[out]  The number of vertices in the clique.
+ *  @return           The vertices of the clique, in increasing order.
+ */
+const int *coloring_get_clique(coloring_t *c, int i, int *size) {
+  *size = c->clique_sizes[i];
+  return c->cliques[i];
+}
+
+
+/** @brief Generates the bipartite graph between vertices and colors.
+ *
+ *  Every vertex (partition 0) may take every color (partition 1). The
+ *  edges of G are not in the graph; they are given by the cliques.
+ *
+ *  @param c  A pointer to a coloring problem.
+ *  @return   A pointer to a graph structure.
+ */
+graph_t *coloring_generate_graph(coloring_t *c) {
+  int sizes[2] = { c->vertices, c->colors };
+  graph_t *g = graph_create_with_sizes(2, sizes);
+  graph_fully_connect_partition(g, 0, 1);
+  return g;
+}
@@ -0,0 +1,56 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file coloring.h
+ *  @brief Instance generator for graph coloring problems.
+ *
+ *  See coloring.c for documentation and implementation details.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#ifndef _COLORING_H_
+#define _COLORING_H_
+
+#include "graph.h"
+
+/** @brief Defines a graph coloring problem.
+ *
+ *  See coloring.c for struct fields and motivation.
+ */
+typedef struct graph_coloring coloring_t;
+
+
+/** Coloring API */
+
+/** Creation and free functions */
+coloring_t *coloring_create(int vertices, int colors, float density, int nedges, int seed);
+void coloring_free(coloring_t *c);
+
+/** Getters */
+int coloring_is_edge(coloring_t *c, int u, int v);
+int coloring_get_num_cliques(coloring_t *c);
+const int *coloring_get_clique(coloring_t *c, int i, int *size);
+
+/** Generators */
+graph_t *coloring_generate_graph(coloring_t *c);
+
+#endif /* _COLORING_H_ */
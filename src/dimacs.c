@@ -0,0 +1,351 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file dimacs.c
+ *  @brief Streaming reader for DIMACS CNF files.
+ *
+ *  The input file is mmap()ed and parsed in place, one clause or comment
+ *  at a time, so the memory used is independent of the size of the file.
+ *  Only the current clause and comment are copied out, into buffers that
+ *  are reused between calls to dimacs_next().
+ *
+ *  Comments before the "p cnf" header are skipped. Comments after it are
+ *  returned in order with the clauses, so that structure such as the
+ *  blocked clause marker written by bipartgen survives a pass through
+ *  the reader.
+ *
+ *  Malformed input prints an error to stderr and calls exit(-1).
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "dimacs.h"
+#include "xmalloc.h"
+
+/** @brief Exits with a parse error message. */
+#define PARSE_ERROR(msg) \
+  do {                                                   \
+    fprintf(stderr, "DIMACS parse error: %s\n", msg);    \
+    exit(-1);                                            \
+  } while (0)
+
+
+/** @brief Defines a DIMACS reader.
+ *
+ *  data:         The mmap()ed file contents.
+ *  size:         The number of bytes in data.
+ *  pos:          The index of the next unread byte.
+ *  body:         The index just after the header, for dimacs_rewind().
+ *  num_vars:     Variable count from the header.
+ *  num_clauses:  Clause count from the header.
+ *  clause:       The most recently read clause, without the trailing 0.
+ *  clause_size:  Number of literals in clause.
+ *  clause_cap:   Allocated length of clause.
+ *  comment:      The most recently read comment, NUL-terminated.
+ *  comment_cap:  Allocated length of comment.
+ */
+struct dimacs_reader {
+  const char *data;
+  size_t size;
+  size_t pos;
+  size_t body;
+  int num_vars;
+  int num_clauses;
+  int *clause;
+  int clause_size;
+  int clause_cap;
+  char *comment;
+  size_t comment_cap;
+}; // dimacs_reader_t
+
+
+/** Helper functions */
+
+/** @brief Advances past spaces, tabs, and carriage returns (not newlines). */
+static void skip_blanks(dimacs_reader_t *r) {
+  while (r->pos < r->size) {
+    char c = r->data[r->pos];
+    if (c != ' ' && c != '\t' && c != '\r') {
+      break;
+    }
+    r->pos++;
+  }
+}
+
+
+/** @brief Advances past all whitespace, including newlines. */
+static void skip_whitespace(dimacs_reader_t *r) {
+  while (r->pos < r->size) {
+    char c = r->data[r->pos];
+    if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+      break;
+    }
+    r->pos++;
+  }
+}
+
+
+/** @brief Advances to just after the next newline. */
+static void skip_line(dimacs_reader_t *r) {
+  const char *nl = memchr(r->data + r->pos, '\n', r->size - r->pos);
+  r->pos = (nl == NULL) ? r->size : (size_t) (nl - r->data) + 1;
+}
+
+
+/** @brief Parses a (possibly negative) decimal integer at the cursor. */
+static int parse_int(dimacs_reader_t *r) {
+  int sign = 1;
+  if (r->pos < r->size && r->data[r->pos] == '-') {
+    sign = -1;
+    r->pos++;
+  }
+
+  if (r->pos >= r->size ||
+      r->data[r->pos] < '0' || r->data[r->pos] > '9') {
+    PARSE_ERROR("expected an integer");
+  }
+
+  long long val = 0;
+  while (r->pos < r->size) {
+    char c = r->data[r->pos];
+    if (c < '0' || c > '9') {
+      break;
+    }
+    val = val * 10 + (c - '0');
+    if (val > 0x7fffffff) {
+      PARSE_ERROR("integer out of range");
+    }
+    r->pos++;
+  }
+
+  return (int) (sign * val);
+}
+
+
+/** DIMACS reader API */
+
+/** @brief Opens a DIMACS file and parses its header.
+ *
+ *  Calls exit(-1) if the file cannot be opened or has no "p cnf" header.
+ *
+ *  @param path  The path of the CNF file.
+ *  @return      A pointer to a reader positioned just after the header.
+ */
+dimacs_reader_t *dimacs_open(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Could not open CNF file %s\n", path);
+    exit(-1);
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size == 0) {
+    fprintf(stderr, "Supplied CNF file %s is empty or unreadable\n", path);
+    exit(-1);
+  }
+
+  void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "Could not map CNF file %s\n", path);
+    exit(-1);
+  }
+  madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+  dimacs_reader_t *r = xmalloc(sizeof(dimacs_reader_t));
+  r->data = data;
+  r->size = st.st_size;
+  r->pos = 0;
+  r->clause_cap = 16;
+  r->clause = xmalloc(r->clause_cap * sizeof(int));
+  r->clause_size = 0;
+  r->comment_cap = 128;
+  r->comment = xmalloc(r->comment_cap);
+  r->comment[0] = '\0';
+
+  // Skip leading comments up to the header
+  while (r->pos < r->size) {
+    skip_whitespace(r);
+    if (r->pos >= r->size || r->data[r->pos] != 'c') {
+      break;
+    }
+    skip_line(r);
+  }
+
+  if (r->size - r->pos < 5 || strncmp(r->data + r->pos, "p cnf", 5) != 0) {
+    PARSE_ERROR("supplied file doesn't follow DIMACS CNF convention");
+  }
+
+  r->pos += 5;
+  skip_blanks(r);
+  r->num_vars = parse_int(r);
+  skip_blanks(r);
+  r->num_clauses = parse_int(r);
+  skip_line(r);
+  r->body = r->pos;
+  return r;
+}
+
+
+/** @brief Moves the reader back to the first clause or comment.
+ *
+ *  The file stays mapped, so a second pass costs no more than the page
+ *  cache, e.g. to count clauses before writing a header.
+ *
+ *  @param r  A pointer to a reader.
+ */
+void dimacs_rewind(dimacs_reader_t *r) {
+  r->pos = r->body;
+  r->clause_size = 0;
+  r->comment[0] = '\0';
+}
+
+
+/** @brief Unmaps the file and frees a reader.
+ *
+ *  @param r  A pointer to a reader.
+ */
+void dimacs_close(dimacs_reader_t *r) {
+  munmap((void *) r->data, r->size);
+  xfree(r->clause);
+  xfree(r->comment);
+  xfree(r);
+}
+
+
+/** @brief Returns the variable count declared in the header.
+ *
+ *  @param r  A pointer to a reader.
+ *  @return   The number of variables in the "p cnf" line.
+ */
+int dimacs_get_num_vars(dimacs_reader_t *r) {
+  return r->num_vars;
+}
+
+
+/** @brief Returns the clause count declared in the header.
+ *
+ *  @param r  A pointer to a reader.
+ *  @return   The number of clauses in the "p cnf" line.
+ */
+int dimacs_get_num_clauses(dimacs_reader_t *r) {
+  return r->num_clauses;
+}
+
+
+/** @brief Returns the clause read by the last call to dimacs_next().
+ *
+ *  The array is owned by the reader and overwritten by the next call to
+ *  dimacs_next(). Callers may modify it in place, e.g. to rename literals.
+ *
+ *  @param r         A pointer to a reader.
+ *  @param size[out] The number of literals, not counting the trailing 0.
+ *  @return          The literals of the clause.
+ */
+int *dimacs_get_clause(dimacs_reader_t *r, int *size) {
+  *size = r->clause_size;
+  return r->clause;
+}
+
+
+/** @brief Returns the comment read by the last call to dimacs_next().
+ *
+ *  The leading 'c' and a single following space are stripped, as is the
+ *  line ending. The string is owned by the reader.
+ *
+ *  @param r  A pointer to a reader.
+ *  @return   The text of the comment.
+ */
+const char *dimacs_get_comment(dimacs_reader_t *r) {
+  return r->comment;
+}
+
+
+/** @brief Reads the next clause or comment.
+ *
+ *  Clauses may span several lines; a clause ends at its 0 literal. A '%'
+ *  line (as in the SATLIB benchmarks) is treated as the end of input.
+ *
+ *  @param r  A pointer to a reader.
+ *  @return   The kind of item read, or DIMACS_EOF.
+ */
+dimacs_item_t dimacs_next(dimacs_reader_t *r) {
+  skip_whitespace(r);
+  if (r->pos >= r->size || r->data[r->pos] == '%') {
+    return DIMACS_EOF;
+  }
+
+  if (r->data[r->pos] == 'c') {
+    size_t start = r->pos + 1;
+    if (start < r->size && r->data[start] == ' ') {
+      start++;
+    }
+
+    skip_line(r);
+    size_t end = r->pos;
+    while (end > start &&
+        (r->data[end - 1] == '\n' || r->data[end - 1] == '\r')) {
+      end--;
+    }
+
+    size_t len = (end > start) ? end - start : 0;
+    if (len + 1 > r->comment_cap) {
+      r->comment_cap = len + 1;
+      r->comment = xrealloc(r->comment, r->comment_cap);
+    }
+    memcpy(r->comment, r->data + start, len);
+    r->comment[len] = '\0';
+    return DIMACS_COMMENT;
+  }
+
+  r->clause_size = 0;
+  while (true) {
+    skip_whitespace(r);
+    if (r->pos >= r->size) {
+      PARSE_ERROR("clause is missing its terminating 0");
+    }
+
+    int lit = parse_int(r);
+    if (lit == 0) {
+      break;
+    } else if (lit > r->num_vars || lit < -r->num_vars) {
+      PARSE_ERROR("literal exceeds the number of variables");
+    }
+
+    if (r->clause_size == r->clause_cap) {
+      r->clause_cap *= 2;
+      r->clause = xrealloc(r->clause, r->clause_cap * sizeof(int));
+    }
+    r->clause[r->clause_size++] = lit;
+  }
+
+  return DIMACS_CLAUSE;
+}
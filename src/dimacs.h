@@ -0,0 +1,67 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file dimacs.h
+ *  @brief Streaming reader for DIMACS CNF files.
+ *
+ *  See dimacs.c for implementation details.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#ifndef _DIMACS_H_
+#define _DIMACS_H_
+
+/** @brief Defines a DIMACS reader.
+ *
+ *  See dimacs.c for struct fields and motivation.
+ */
+typedef struct dimacs_reader dimacs_reader_t;
+
+
+/** @brief The kinds of items returned by dimacs_next().
+ *
+ *  DIMACS_CLAUSE:  A clause was read; see dimacs_get_clause().
+ *  DIMACS_COMMENT: A comment line was read; see dimacs_get_comment().
+ *  DIMACS_EOF:     No more input.
+ */
+typedef enum dimacs_item {
+  DIMACS_CLAUSE, DIMACS_COMMENT, DIMACS_EOF
+} dimacs_item_t;
+
+
+/** DIMACS reader API */
+
+/** Creation and free functions */
+dimacs_reader_t *dimacs_open(const char *path);
+void dimacs_close(dimacs_reader_t *r);
+
+/** Getters */
+int dimacs_get_num_vars(dimacs_reader_t *r);
+int dimacs_get_num_clauses(dimacs_reader_t *r);
+int *dimacs_get_clause(dimacs_reader_t *r, int *size);
+const char *dimacs_get_comment(dimacs_reader_t *r);
+
+/** Iteration */
+dimacs_item_t dimacs_next(dimacs_reader_t *r);
+void dimacs_rewind(dimacs_reader_t *r);
+
+#endif /* _DIMACS_H_ */
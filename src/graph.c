@@ -32,6 +32,8 @@
 
 #include <stdio.h> // For printf
 #include <limits.h> // For INT_MAX
+#include <stdint.h> // For uint64_t
+#include <stdbool.h>
 
 #include "graph.h"
 #include "xmalloc.h"
@@ -206,9 +208,100 @@ static int *hp2s = NULL;
 static int *hp2os = NULL;
 static graph_t *helper_g = NULL;
 
+/** @brief Largest matching size searched with induced adjacency masks.
+ *
+ *  A k x k induced adjacency fits in 64 bits up to k = 8, with row i (the
+ *  i-th node of hp1s) in byte i and column j (the j-th node of hp2s) at bit
+ *  j of that byte. An ordering, read as a perfect matching, has the same
+ *  layout, with exactly one bit per row and per column.
+ */
+#define MASK_MAX_SIZE    8
+#define MASK_ROW(m, i)   (((m) >> (BITS_IN_BYTE * (i))) & 0xff)
+
+/** @brief Orderings of each size as masks, in the order they are searched */
+static uint64_t *perm_masks[MASK_MAX_SIZE + 1];
+static int perm_counts[MASK_MAX_SIZE + 1];
+
+/** @brief The group of edge-disjoint orderings found on hp1s and hp2s.
+ *
+ *  A group is opened for each pair of vertex sets and closed once all of
+ *  their orderings have been searched. At most helper_size orderings can
+ *  be edge-disjoint, so the buffer holds up_to_size^2 entries.
+ */
+static int *group_orderings = NULL;
+static int group_size = 0;
+
+/** @brief Necessary conditions on the vertex sets, see generate_permutations.
+ *
+ *  "left_nbrs" holds, for each node of hp1, its neighbors in hp2 as a
+ *  bitset of helper_words words. "cover_once" and "cover_twice" hold, for
+ *  each prefix of hp1s by length, the nodes of hp2 with at least one and
+ *  at least two neighbors in the prefix. "right_cands" are the nodes of hp2 with
+ *  at least two neighbors in hp1s, from which hp2s is drawn, and
+ *  "right_suffix" counts, for each node of hp1s, its neighbors among
+ *  right_cands[t] and after. "left_degree" counts the neighbors of each
+ *  node of hp1s among the chosen nodes of hp2s.
+ */
+static int helper_words = 0;
+static uint64_t *left_nbrs = NULL;
+static uint64_t *cover_once = NULL;
+static uint64_t *cover_twice = NULL;
+static int *right_cands = NULL;
+static int num_right_cands = 0;
+static int *right_suffix = NULL;
+static int *left_degree = NULL;
+
 
 /** Helper functions */
 
+/** @brief Finds the first set (or, if complement, clear) bit at or after
+ *         from in a bitvector row of size bits.
+ *
+ *  The row is scanned up to 64 bits at a time, so sparse rows (or dense
+ *  rows, when looking for non-edges) are skipped a word at a time rather
+ *  than a bit at a time. Words are assembled byte by byte, so the result
+ *  does not depend on the endianness of the machine.
+ *
+ *  @param row         The bitvector, bit n in byte n / 8 at n % 8.
+ *  @param size        The number of valid bits in row.
+ *  @param from        The first bit to consider.
+ *  @param complement  Whether to look for clear bits instead of set bits.
+ *  @return            The index of the bit, or -1 if there is none.
+ */
+static int scan_row(const unsigned char *row, int size, int from,
+    bool complement) {
+  const int bytes = ROUND_UP(size, BITS_IN_BYTE) / BITS_IN_BYTE;
+  int bit = from;
+  while (bit < size) {
+    const int byte = bit / BITS_IN_BYTE;
+    const int take = (bytes - byte < 8) ? bytes - byte : 8;
+    uint64_t word = 0;
+    for (int b = 0; b < take; b++) {
+      word |= ((uint64_t) row[byte + b]) << (BITS_IN_BYTE * b);
+    }
+    if (complement) {
+      word = ~word;
+    }
+
+    // Align the word so that bit 0 is the bit at index "bit"
+    const int shift = bit & BYTE_MASK;
+    const int avail = take * BITS_IN_BYTE - shift;
+    word >>= shift;
+    if (avail < 64) {
+      word &= (((uint64_t) 1) << avail) - 1;
+    }
+
+    if (word != 0) {
+      const int n = bit + __builtin_ctzll(word);
+      return (n < size) ? n : -1;
+    }
+    bit += avail;
+  }
+
+  return -1;
+}
+
+
 /** @brief Performs common invariant checks on a graph.
  *
  *  Ensures that the partitions and node indexes are in range, given
@@ -330,6 +423,33 @@ graph_t *graph_create_with_sizes(int partitions, int *sizes) {
 }
 
 
+/** @brief Removes all edges from a graph, keeping its allocations.
+ *
+ *  Zeroes the edge bitvectors and neighbor counts, in time linear in
+ *  their size, so one graph can be refilled, e.g. for a range of seeds.
+ *  Perfect matchings are not touched.
+ *
+ *  @param g  A pointer to a graph.
+ */
+void graph_clear(graph_t *g) {
+  const int partitions = g->partitions;
+  memset(g->partition_edges, 0, partitions * sizeof(int));
+  for (int i = 0; i < partitions; i++) {
+    for (int j = 0; j < partitions; j++) {
+      if (i == j)
+        continue;
+
+      const int size = g->partition_sizes[i];
+      const int bitvec_size = ROUND_UP(g->partition_sizes[j], BITS_IN_BYTE) / BITS_IN_BYTE;
+      memset(g->num_neighbors[i][j], 0, size * sizeof(int));
+      for (int k = 0; k < size; k++) {
+        memset(g->edges[i][j][k], 0, bitvec_size);
+      }
+    }
+  }
+}
+
+
 /** @brief Frees the memory allocated for a graph.
  *
  *  @param g  A pointer to a graph to free.
@@ -377,8 +497,6 @@ void graph_free(graph_t *g) {
         while (h->head != NULL) {
           graph_remove_matching(g, i, k, j, h->head);
         }
-
-        xfree(h);
       }
 
       xfree(g->matchings[i][j]);
@@ -389,6 +507,7 @@ void graph_free(graph_t *g) {
 
   // Free remaining fields
   xfree(g->partition_sizes);
+  xfree(g->partition_edges);
   xfree(g->num_neighbors);
   xfree(g->edges);
   xfree(g->matchings);
@@ -498,6 +617,48 @@ int *graph_get_neighbors(graph_t *g, int p1, int n1, int p2, int *size) {
 }
 
 
+/** @brief Returns the next neighbor of a node, for iterating without
+ *         allocating a neighbor array.
+ *
+ *  Iterate with
+ *
+ *    for (n2 = graph_get_next_neighbor(g, p1, n1, p2, 0); n2 >= 0;
+ *         n2 = graph_get_next_neighbor(g, p1, n1, p2, n2 + 1))
+ *
+ *  which visits the same nodes, in the same order, as graph_get_neighbors().
+ *
+ *  @param g     A pointer to a graph.
+ *  @param p1    The index of the partition the node is in.
+ *  @param n1    The node number of the node.
+ *  @param p2    The index of the partition the node is "querying."
+ *  @param from  The first node in p2 to consider.
+ *  @return      The smallest n2 >= from with an edge to n1, or -1.
+ */
+int graph_get_next_neighbor(graph_t *g, int p1, int n1, int p2, int from) {
+  return scan_row((const unsigned char *) g->edges[p1][p2][n1],
+      g->partition_sizes[p2], from, false);
+}
+
+
+/** @brief Returns the next node in a partition NOT adjacent to a node.
+ *
+ *  Iterated like graph_get_next_neighbor(). Dense rows are skipped a word
+ *  at a time, so listing the non-edges of a graph does not cost a call
+ *  to graph_is_edge_between() per pair of nodes.
+ *
+ *  @param g     A pointer to a graph.
+ *  @param p1    The index of the partition the node is in.
+ *  @param n1    The node number of the node.
+ *  @param p2    The index of the partition the node is "querying."
+ *  @param from  The first node in p2 to consider.
+ *  @return      The smallest n2 >= from with no edge to n1, or -1.
+ */
+int graph_get_next_non_neighbor(graph_t *g, int p1, int n1, int p2, int from) {
+  return scan_row((const unsigned char *) g->edges[p1][p2][n1],
+      g->partition_sizes[p2], from, true);
+}
+
+
 /** @brief Returns the ID of an edge between two nodes. The ID will
  *         be 1-indexed.
  *
@@ -581,6 +742,44 @@ void graph_add_edge(graph_t *g, int p1, int n1, int p2, int n2) {
 }
 
 
+/** @brief Adds a batch of edges between two partitions.
+ *
+ *  Same as graph_add_edge() on each pair (n1s[i], n2s[i]), but generators
+ *  that build many edges at once avoid a call and the checks per edge.
+ *  Edges already present, or repeated in the batch, are added once.
+ *
+ *  @param g      A pointer to a graph.
+ *  @param p1     The index of the first partition.
+ *  @param p2     The index of the second partition.
+ *  @param n1s    The node numbers in the first partition.
+ *  @param n2s    The node numbers in the second partition.
+ *  @param count  The number of edges.
+ */
+void graph_add_edges(graph_t *g, int p1, int p2,
+    const int *n1s, const int *n2s, int count) {
+  char **forward = g->edges[p1][p2];
+  char **backward = g->edges[p2][p1];
+  int *forward_degrees = g->num_neighbors[p1][p2];
+  int *backward_degrees = g->num_neighbors[p2][p1];
+  int added = 0;
+  for (int i = 0; i < count; i++) {
+    const int n1 = n1s[i], n2 = n2s[i];
+    char *byte = &forward[n1][n2 / BITS_IN_BYTE];
+    if ((*byte >> (n2 & BYTE_MASK)) & 0x1) {
+      continue;
+    }
+
+    *byte |= (1 << (n2 & BYTE_MASK));
+    backward[n2][n1 / BITS_IN_BYTE] |= (1 << (n1 & BYTE_MASK));
+    forward_degrees[n1]++;
+    backward_degrees[n2]++;
+    added++;
+  }
+
+  g->partition_edges[(p1 < p2) ? p1 : p2] += added;
+}
+
+
 /** @brief Removes an edge from one node to another.
  *
  *  All array (partition, node) accesses are 0-indexed. Removes the edge
@@ -651,59 +850,149 @@ void graph_fully_connect_partition(graph_t *g, int p1, int p2) {
 }
 
 
-/** @brief Returns the size of the shared neighborhood between the vertices.
+/** @brief Finds the root of a node in a union-find forest, halving paths. */
+static int find_root(int *parent, int u) {
+  while (parent[u] != u) {
+    parent[u] = parent[parent[u]];
+    u = parent[u];
+  }
+  return u;
+}
+
+
+/** @brief Counts the connected components of the graph.
  *
- *  TODO hard-coded from partition 0 to 1.
+ *  Nodes of all partitions are numbered in partition order and joined by
+ *  union-find (union by size, path halving) over every edge, so the count
+ *  takes near-linear time in the nodes and edges, plus a scan of the edge
+ *  bitsets. Isolated nodes are components of their own.
+ *
+ *  @param g   A pointer to the graph structure.
+ *  @return    The number of connected components.
  */
-static int get_shared_neighborhood_size(int *verts, int num) {
-  int size;
-  int *neighs = graph_get_neighbors(helper_g, 0, verts[0], 1, &size);
-  int left = size;
-
-  for (int i = 1; i < num; i++) {
-    int s;
-    int *ns = graph_get_neighbors(helper_g, 0, verts[i], 1, &s);
-    for (int j = 0; j < left; j++) {
-      int val = neighs[j];
-      int found = 0;
-      for (int s_idx = 0; s_idx < s; s_idx++) {
-        if (ns[s_idx] == val) {
-          found = 1;
-          break;
+int graph_count_components(graph_t *g) {
+  const int k = g->partitions;
+  int *first = xmalloc((k + 1) * sizeof(int));
+  first[0] = 0;
+  for (int p = 0; p < k; p++) {
+    first[p + 1] = first[p] + g->partition_sizes[p];
+  }
+
+  const int total = first[k];
+  int *parent = xmalloc((total + 1) * sizeof(int));
+  int *size = xmalloc((total + 1) * sizeof(int));
+  for (int u = 0; u < total; u++) {
+    parent[u] = u;
+    size[u] = 1;
+  }
+
+  int components = total;
+  for (int p1 = 0; p1 < k; p1++) {
+    for (int p2 = p1 + 1; p2 < k; p2++) {
+      for (int n1 = 0; n1 < g->partition_sizes[p1]; n1++) {
+        for (int n2 = graph_get_next_neighbor(g, p1, n1, p2, 0); n2 >= 0;
+            n2 = graph_get_next_neighbor(g, p1, n1, p2, n2 + 1)) {
+          int a = find_root(parent, first[p1] + n1);
+          int b = find_root(parent, first[p2] + n2);
+          if (a == b) continue;
+          if (size[a] < size[b]) {
+            const int tmp = a;
+            a = b;
+            b = tmp;
+          }
+          parent[b] = a;
+          size[a] += size[b];
+          components--;
         }
       }
+    }
+  }
 
-      if (!found) {
-        memmove(neighs + j, neighs + j + 1, ((left - j) - 1) * sizeof(int));
-        left--;
-        j--;
-      }
+  xfree(first);
+  xfree(parent);
+  xfree(size);
+  return components;
+}
+
+
+/** @brief Adds an ordering to the open group.
+ *
+ *  @param ordering  Maps hp1s[i] to hp2s[ordering[i]].
+ */
+static void add_to_group(const int *ordering) {
+  memcpy(group_orderings + group_size * helper_size, ordering,
+      helper_size * sizeof(int));
+  group_size++;
+}
+
+
+/** @brief Closes the group, storing it as a set of perfect matchings.
+ *
+ *  The set is appended to the list rooted at hp1s[0]. Because perfect
+ *  matchings are only kept for blocking, a group with fewer than two
+ *  orderings is dropped.
+ */
+static void close_group(void) {
+  if (group_size < 2) {
+    return;
+  }
+
+  matching_t *m = xmalloc(sizeof(matching_t));
+  m->size = helper_size;
+  m->p1_nodes = xmalloc(helper_size * sizeof(int));
+  m->p2_nodes = xmalloc(helper_size * sizeof(int));
+  m->num_orderings = group_size;
+  memcpy(m->p1_nodes, hp1s, helper_size * sizeof(int));
+  memcpy(m->p2_nodes, hp2s, helper_size * sizeof(int));
+
+  node_ordering_t *prev = NULL;
+  for (int o = 0; o < group_size; o++) {
+    node_ordering_t *ordering = xmalloc(sizeof(node_ordering_t));
+    ordering->ordering = xmalloc(helper_size * sizeof(int));
+    memcpy(ordering->ordering, group_orderings + o * helper_size,
+        helper_size * sizeof(int));
+    ordering->prev = prev;
+    ordering->next = NULL;
+    if (prev != NULL) {
+      prev->next = ordering;
+    } else {
+      m->head = ordering;
     }
+    prev = ordering;
+  }
+  m->tail = prev;
+  m->iterator = m->head;
 
-    xfree(ns);
+  // Insert into the back of the list
+  matching_header_t *h = &helper_g->matchings[hp1][hp2][hp1s[0]];
+  m->next = NULL;
+  if (h->tail != NULL) {
+    h->tail->next = m;
+    m->prev = h->tail;
+  } else {
+    h->head = m;
+    m->prev = NULL;
   }
 
-  xfree(neighs);
-  return left;
+  h->tail = m;
+  h->matchings += group_size;
 }
 
 
-/** @brief Returns the minimum size of the pairwise shared neighborhoods
- *         between the vertices.
+/** @brief Checks whether the first (last + 1) entries of hp2os share an
+ *         edge with an ordering of the open group.
  */
-static int get_pairwise_neighborhood_min_size(int *verts, int num) {
-  int min = INT_MAX;
-  for (int i = 0; i < num; i++) {
-    for (int j = i + 1; j < num; j++) {
-      int arr[2] = {verts[i], verts[j]};
-      int res = get_shared_neighborhood_size(arr, 2);
-      if (res < min) {
-        min = res;
+static bool shares_group_edge(int last) {
+  for (int o = 0; o < group_size; o++) {
+    const int *ordering = group_orderings + o * helper_size;
+    for (int i = 0; i <= last; i++) {
+      if (ordering[i] == hp2os[i]) {
+        return true;
       }
     }
   }
 
-  return min;
+  return false;
 }
 
 
@@ -717,74 +1006,11 @@ static void generate_subset_permutations(int lo) {
     // Check the final edge for existence
     int map = hp2os[lo];
     if (graph_is_edge_between(helper_g, hp1, hp1s[lo], hp2, hp2s[map])) {
-      // Have a perfect matching, add to the list
-      // But only add it if there are no edges in common with any
-      // of the previous perfect matchings of these two sets
-      matching_header_t *h = &helper_g->matchings[hp1][hp2][hp1s[0]];
-      if (h->tail != NULL) {
-        // Assume that we take the matchings in lexicographic order - only end
-        // TODO remove
-        matching_t *curr = h->tail;
-        if (curr->size == helper_size &&
-            memcmp(curr->p1_nodes, hp1s, helper_size * sizeof(int)) == 0 &&
-            memcmp(curr->p2_nodes, hp2s, helper_size * sizeof(int)) == 0) {
-          // Vertex sets are the same - check for a shared edge in any found
-          node_ordering_t *iter = curr->head;
-          while (iter != NULL) {
-            for (int i = 0; i < helper_size; i++) {
-              if (iter->ordering[i] == hp2os[i]) {
-                 return;
-              }
-            }
-
-            iter = iter->next;
-          }
-
-          // Doesn't share a matching, so add an ordering
-          node_ordering_t *new_ordering = xmalloc(sizeof(node_ordering_t));
-          new_ordering->ordering = xmalloc(helper_size * sizeof(int));
-          memcpy(new_ordering->ordering, hp2os, helper_size * sizeof(int));
-
-          // Add to the linked list - at the tail
-          new_ordering->prev = curr->tail;
-          new_ordering->next = NULL;
-          curr->tail->next = new_ordering;
-          curr->num_orderings++;
-          curr->tail = new_ordering;
-          h->matchings++;
-          return;
-        }
-      }
-
-      // New matching struct is necessary
-      matching_t *m = xmalloc(sizeof(matching_t));
-      node_ordering_t *ordering = xmalloc(sizeof(node_ordering_t));
-      ordering->ordering = xmalloc(helper_size * sizeof(int));
-      m->size = helper_size;
-      m->p1_nodes = xmalloc(helper_size * sizeof(int));
-      m->p2_nodes = xmalloc(helper_size * sizeof(int));
-      m->num_orderings = 1;
-      m->head = ordering;
-      m->tail = ordering;
-      m->iterator = ordering;
-      memcpy(m->p1_nodes, hp1s, helper_size * sizeof(int));
-      memcpy(m->p2_nodes, hp2s, helper_size * sizeof(int));
-      memcpy(ordering->ordering, hp2os, helper_size * sizeof(int));
-      ordering->next = NULL;
-      ordering->prev = NULL;
-
-      // Insert into the back of the list
-      m->next = NULL;
-      if (h->tail != NULL) {
-        h->tail->next = m;
-        m->prev = h->tail;
-      } else {
-        h->head = m;
-        m->prev = NULL;
+      // Have a perfect matching, but only add it to the group if there
+      // are no edges in common with any of its previous perfect matchings
+      if (!shares_group_edge(helper_size - 1)) {
+        add_to_group(hp2os);
       }
-
-      h->tail = m;
-      h->matchings++;
     }
   } else {
     for (int i = lo; i < helper_size; i++) {
@@ -796,34 +1022,13 @@ static void generate_subset_permutations(int lo) {
       int map = hp2os[lo];
       if (graph_is_edge_between(helper_g, hp1, hp1s[lo], hp2, hp2s[map])) {
         // Check that we are not sharing an edge with a previously found p.m.
-        // that has the same vertex sets on left and right
-        // Since we are adding matchings to the tail, only check last one
-        matching_header_t *h = &helper_g->matchings[hp1][hp2][hp1s[0]];
-        if (h->tail != NULL) {
-          matching_t *curr = h->tail;
-          // Examine left and right for match, then check for shared edge
-          if (curr->size == helper_size &&
-              memcmp(curr->p1_nodes, hp1s, helper_size * sizeof(int)) == 0 &&
-              memcmp(curr->p2_nodes, hp2s, helper_size * sizeof(int)) == 0) {
-            node_ordering_t *iter = curr->head;
-            while (iter != NULL) {
-              int end = (lo == helper_size - 2) ? helper_size - 1 : lo;
-              for (int i = 0; i <= end; i++) {
-                if (iter->ordering[i] == hp2os[i]) {
-                  goto swap;
-                }
-              }
-
-              iter = iter->next;
-            }
-          }
+        // of the group. At the second to last node, the last is forced
+        int end = (lo == helper_size - 2) ? helper_size - 1 : lo;
+        if (!shares_group_edge(end)) {
+          generate_subset_permutations(lo + 1);
         }
-
-        // Nothing found on shared edge check - keep going!
-        generate_subset_permutations(lo + 1);
       }
 
-swap:
       temp = hp2os[lo];
       hp2os[lo] = hp2os[i];
       hp2os[i] = temp;
@@ -832,86 +1037,393 @@ swap:
 }
 
 
-static void generate_permutations(const int p1_size, const int p2_size) {
-  // Reset the p1s array
+/** @brief Records each ordering of the swap recursion as a mask.
+ *
+ *  The orderings are visited in the order of generate_subset_permutations(),
+ *  so that both searches accept the same perfect matchings.
+ */
+static void fill_perm_masks(int *ordering, int lo, int size,
+    uint64_t *masks, int *count) {
+  if (lo == size - 1) {
+    uint64_t m = 0;
+    for (int i = 0; i < size; i++) {
+      m |= ((uint64_t) 1) << (BITS_IN_BYTE * i + ordering[i]);
+    }
+    masks[(*count)++] = m;
+    return;
+  }
+
+  for (int i = lo; i < size; i++) {
+    int temp = ordering[lo];
+    ordering[lo] = ordering[i];
+    ordering[i] = temp;
+    fill_perm_masks(ordering, lo + 1, size, masks, count);
+    ordering[i] = ordering[lo];
+    ordering[lo] = temp;
+  }
+}
+
+
+/** @brief Builds the adjacency mask induced by hp1s and hp2s.
+ *
+ *  Stops at the first node of hp1s without a neighbor in hp2s, returning
+ *  the partial mask, since no perfect matching is then possible.
+ */
+static uint64_t get_induced_adjacency(void) {
+  uint64_t adj = 0;
   for (int i = 0; i < helper_size; i++) {
-    hp1s[i] = i;
+    const char *row = helper_g->edges[hp1][hp2][hp1s[i]];
+    uint64_t bits = 0;
+    for (int j = 0; j < helper_size; j++) {
+      const int n2 = hp2s[j];
+      bits |= (uint64_t) ((row[n2 / BITS_IN_BYTE] >> (n2 & BYTE_MASK)) & 0x1)
+        << j;
+    }
+
+    if (bits == 0) {
+      return adj;
+    }
+    adj |= bits << (BITS_IN_BYTE * i);
   }
 
-  // Run through all subsets of p1_size for hp1s
-  while (hp1s[0] < p1_size - helper_size + 1) {
-    // Analysis on neighbors of hp1s for intersection.
-    // Based on hard-coded
-    if (helper_size == 2) {
-      // We are looking for K_{2, 2}s, so any pair of starting nodes need
-      // a shared neighborhood of at least two
-      if (get_shared_neighborhood_size(hp1s, 2) < 2) {
-        goto permute_p1;
+  return adj;
+}
+
+
+/** @brief Checks that every row and column of a mask has a set bit.
+ *
+ *  This is necessary for the mask to contain a perfect matching.
+ */
+static bool covers_all_nodes(uint64_t adj) {
+  uint64_t cols = 0;
+  for (int i = 0; i < helper_size; i++) {
+    const uint64_t row = MASK_ROW(adj, i);
+    if (row == 0) {
+      return false;
+    }
+    cols |= row;
+  }
+
+  return cols == (((uint64_t) 1) << helper_size) - 1;
+}
+
+
+/** @brief Checks that a mask can hold two edge-disjoint perfect matchings.
+ *
+ *  Their union is a set of disjoint even cycles covering all nodes, so
+ *  every node has two neighbors, and every connected component of the
+ *  mask has as many nodes on the left as on the right.
+ */
+static bool supports_two_matchings(uint64_t adj) {
+  uint64_t cols = 0;
+  for (int i = 0; i < helper_size; i++) {
+    const uint64_t row = MASK_ROW(adj, i);
+    if (__builtin_popcountll(row) < 2) {
+      return false;
+    }
+    cols |= row;
+  }
+
+  for (int j = 0; j < helper_size; j++) {
+    if (__builtin_popcountll(adj & (0x0101010101010101ULL << j)) < 2) {
+      return false;
+    }
+  }
+
+  // Grow the component of each unvisited row, alternating sides
+  uint64_t unvisited = (((uint64_t) 1) << helper_size) - 1;
+  while (unvisited != 0) {
+    uint64_t rows = unvisited & -unvisited;
+    uint64_t comp_cols = 0;
+    uint64_t prev_rows = 0;
+    while (rows != prev_rows) {
+      prev_rows = rows;
+      for (int i = 0; i < helper_size; i++) {
+        if ((rows >> i) & 0x1) {
+          comp_cols |= MASK_ROW(adj, i);
+        }
       }
-    } else if (helper_size == 3) {
-      // If the shared neighborhood is less than 3, then look for C6s
-      if (get_shared_neighborhood_size(hp1s, 3) < 3 &&
-          get_pairwise_neighborhood_min_size(hp1s, 3) < 1) {
-        goto permute_p1;
+      for (int i = 0; i < helper_size; i++) {
+        if (MASK_ROW(adj, i) & comp_cols) {
+          rows |= ((uint64_t) 1) << i;
+        }
       }
     }
-    
 
-    // Reset p2 array
+    if (__builtin_popcountll(rows) != __builtin_popcountll(comp_cols)) {
+      return false;
+    }
+    unvisited &= ~rows;
+  }
+
+  return true;
+}
+
+
+/** @brief Finds the edge-disjoint perfect matchings on hp1s and hp2s.
+ *
+ *  Does the work of generate_subset_permutations() for sizes up to
+ *  MASK_MAX_SIZE. Each ordering in the table is a perfect matching if
+ *  its mask lies within the induced adjacency, and shares no edge with
+ *  the matchings accepted so far if it misses their union.
+ */
+static void generate_subset_masks(void) {
+  uint64_t adj = get_induced_adjacency();
+  if (!supports_two_matchings(adj)) {
+    return;
+  }
+
+  const uint64_t *masks = perm_masks[helper_size];
+  const int count = perm_counts[helper_size];
+  uint64_t used = 0;
+  int ordering[MASK_MAX_SIZE];
+  for (int p = 0; p < count; p++) {
+    const uint64_t m = masks[p];
+    if ((m & ~adj) != 0 || (m & used) != 0) {
+      continue;
+    }
+
     for (int i = 0; i < helper_size; i++) {
-      hp2s[i] = i;
+      ordering[i] = __builtin_ctzll(MASK_ROW(m, i));
+    }
+
+    add_to_group(ordering);
+
+    // Stop once the unused edges can no longer hold a perfect matching
+    used |= m;
+    if (!covers_all_nodes(adj & ~used)) {
+      return;
+    }
+  }
+}
+
+
+/** @brief Stores the neighbors of each node of hp1 in hp2 as words. */
+static void fill_left_neighbors(const int p1_size, const int p2_size) {
+  const int bytes = ROUND_UP(p2_size, BITS_IN_BYTE) / BITS_IN_BYTE;
+  for (int n = 0; n < p1_size; n++) {
+    const unsigned char *row =
+      (const unsigned char *) helper_g->edges[hp1][hp2][n];
+    uint64_t *words = left_nbrs + n * helper_words;
+    memset(words, 0, helper_words * sizeof(uint64_t));
+    for (int b = 0; b < bytes; b++) {
+      words[b / 8] |= ((uint64_t) row[b]) << (BITS_IN_BYTE * (b % 8));
+    }
+  }
+}
+
+
+/** @brief Checks whether node n1 of hp1 is joined to node n2 of hp2. */
+static inline bool is_left_neighbor(int n1, int n2) {
+  return (left_nbrs[n1 * helper_words + n2 / 64] >> (n2 % 64)) & 0x1;
+}
+
+
+/** @brief Checks the left nodes hp1s, and collects the right candidates.
+ *
+ *  Two edge-disjoint perfect matchings give every node two neighbors on
+ *  the other side. So hp2s is drawn from the nodes of hp2 with two
+ *  neighbors in hp1s, of which there must be helper_size (Hall's
+ *  condition), and every node of hp1s needs two neighbors among them.
+ *
+ *  @param twice  The nodes of hp2 with two neighbors in hp1s.
+ *  @return false if no pair of edge-disjoint perfect matchings can
+ *          include hp1s, true otherwise.
+ */
+static bool collect_right_candidates(const uint64_t *twice) {
+  int covered = 0;
+  for (int w = 0; w < helper_words; w++) {
+    covered += __builtin_popcountll(twice[w]);
+  }
+  if (covered < helper_size) {
+    return false;
+  }
+
+  for (int i = 0; i < helper_size; i++) {
+    const uint64_t *words = left_nbrs + hp1s[i] * helper_words;
+    int degree = 0;
+    for (int w = 0; w < helper_words; w++) {
+      degree += __builtin_popcountll(words[w] & twice[w]);
+    }
+    if (degree < 2) {
+      return false;
+    }
+  }
+
+  num_right_cands = 0;
+  for (int w = 0; w < helper_words; w++) {
+    for (uint64_t word = twice[w]; word != 0; word &= word - 1) {
+      right_cands[num_right_cands++] = w * 64 + __builtin_ctzll(word);
+    }
+  }
+
+  // Count the neighbors of each left node from each candidate on
+  const int stride = num_right_cands + 1;
+  for (int i = 0; i < helper_size; i++) {
+    int *suffix = right_suffix + i * stride;
+    suffix[num_right_cands] = 0;
+    for (int t = num_right_cands - 1; t >= 0; t--) {
+      suffix[t] = suffix[t + 1] + is_left_neighbor(hp1s[i], right_cands[t]);
     }
+    left_degree[i] = 0;
+  }
+
+  return true;
+}
 
-    // Run through all subsets of p2_size for hp2s
-    while (hp2s[0] < p2_size - helper_size + 1) {
+
+/** @brief Runs through the subsets hp2s of the right candidates.
+ *
+ *  Subsets are visited in lexicographic order. A prefix is cut off once
+ *  some node of hp1s cannot get two neighbors in hp2s from the remaining
+ *  candidates.
+ *
+ *  @param depth  The number of nodes of hp2s chosen.
+ *  @param from   The index of the first candidate left to choose.
+ */
+static void choose_right_nodes(int depth, int from) {
+  if (depth == helper_size) {
+    group_size = 0;
+    if (helper_size <= MASK_MAX_SIZE) {
+      generate_subset_masks();
+    } else {
       // Reset the ordering array
       for (int i = 0; i < helper_size; i++) {
         hp2os[i] = i;
       }
 
-      // Run through all permutations of subsets of p2 and check for perf. mat.
+      // Run through all permutations of subsets of p2 and check for p.m.
       generate_subset_permutations(0);
+    }
+    close_group();
+    return;
+  }
 
-      // Increment the end of p2s, modulo by size
-      hp2s[helper_size - 1]++;
-      while (hp2s[helper_size - 1] >= p2_size) {
-        int idx = helper_size - 1;
-        do {
-          idx--;
-          hp2s[idx]++;
-        } while (hp2s[idx] >= p2_size && idx > 0);
-
-        // Now that we stopped, we found an element that is not above n
-        // Propagate this value monotonically down the line
-        for (int l = idx + 1; l < helper_size; l++) {
-          hp2s[l] = hp2s[l - 1] + 1;
-        }
+  const int stride = num_right_cands + 1;
+  for (int t = from; t <= num_right_cands - (helper_size - depth); t++) {
+    const int r = right_cands[t];
+    hp2s[depth] = r;
 
-        if (hp2s[0] >= p2_size - helper_size + 1) 
-          break;
+    bool feasible = true;
+    for (int i = 0; i < helper_size; i++) {
+      left_degree[i] += is_left_neighbor(hp1s[i], r);
+      if (left_degree[i] + right_suffix[i * stride + t + 1] < 2) {
+        feasible = false;
       }
     }
-    
-permute_p1:
-    // Increment the end of p1s, modulo by size
-    hp1s[helper_size - 1]++;
-    while (hp1s[helper_size - 1] >= p1_size) {
-      int idx = helper_size - 1;
-      do {
-        idx--;
-        hp1s[idx]++;
-      } while (hp1s[idx] >= p1_size && idx > 0);
-
-      // Now that we stopped, we found an element that is not above n
-      // Propagate this value monotonically down the line
-      for (int l = idx + 1; l < helper_size; l++) {
-        hp1s[l] = hp1s[l - 1] + 1;
-      }
 
-      if (hp1s[0] >= p1_size - helper_size + 1) 
-        break;
+    if (feasible) {
+      choose_right_nodes(depth + 1, t + 1);
+    }
+
+    for (int i = 0; i < helper_size; i++) {
+      left_degree[i] -= is_left_neighbor(hp1s[i], r);
+    }
+  }
+}
+
+
+/** @brief Checks the neighborhood that node n shares with each of hp1s.
+ *
+ *  The two edge-disjoint perfect matchings on two nodes form a K_{2,2}, so
+ *  the nodes share two neighbors. On three nodes they form a C6, in which
+ *  every pair of nodes shares a neighbor. No such bound holds for more.
+ *
+ *  @param n      A node of hp1.
+ *  @param depth  The number of nodes of hp1s to check against.
+ */
+static bool shares_enough_neighbors(int n, int depth) {
+  const int needed = (helper_size == 2) ? 2 : (helper_size == 3) ? 1 : 0;
+  if (needed == 0) {
+    return true;
+  }
+
+  const uint64_t *words = left_nbrs + n * helper_words;
+  for (int d = 0; d < depth; d++) {
+    const uint64_t *other = left_nbrs + hp1s[d] * helper_words;
+    int shared = 0;
+    for (int w = 0; w < helper_words && shared < needed; w++) {
+      shared += __builtin_popcountll(words[w] & other[w]);
+    }
+    if (shared < needed) {
+      return false;
     }
   }
+
+  return true;
+}
+
+
+/** @brief Runs through the subsets hp1s of hp1, extending a prefix.
+ *
+ *  Subsets are visited in lexicographic order. The nodes of hp2 covered
+ *  once and twice by the prefix are carried along, so each extension
+ *  costs one pass over a neighborhood. Nodes with fewer than two
+ *  neighbors in hp2, or sharing too few with the prefix, are never added,
+ *  cutting off every subset that would contain them.
+ *
+ *  @param p1_size  The number of nodes in hp1.
+ *  @param depth    The number of nodes of hp1s chosen.
+ *  @param from     The first node of hp1 left to choose.
+ */
+static void choose_left_nodes(const int p1_size, int depth, int from) {
+  const uint64_t *once = cover_once + depth * helper_words;
+  const uint64_t *twice = cover_twice + depth * helper_words;
+  if (depth == helper_size) {
+    // Run through the subsets of p2 that can match hp1s twice
+    if (collect_right_candidates(twice)) {
+      choose_right_nodes(0, 0);
+    }
+    return;
+  }
+
+  uint64_t *next_once = cover_once + (depth + 1) * helper_words;
+  uint64_t *next_twice = cover_twice + (depth + 1) * helper_words;
+  for (int n = from; n <= p1_size - (helper_size - depth); n++) {
+    if (helper_g->num_neighbors[hp1][hp2][n] < 2 ||
+        !shares_enough_neighbors(n, depth)) {
+      continue;
+    }
+
+    hp1s[depth] = n;
+    const uint64_t *words = left_nbrs + n * helper_words;
+    for (int w = 0; w < helper_words; w++) {
+      next_twice[w] = twice[w] | (once[w] & words[w]);
+      next_once[w] = once[w] | words[w];
+    }
+    choose_left_nodes(p1_size, depth + 1, n + 1);
+  }
+}
+
+
+/** @brief Finds the perfect matchings of size helper_size between hp1, hp2.
+ *
+ *  Only vertex sets with two edge-disjoint perfect matchings are kept, so
+ *  sets failing a necessary condition for them are skipped: on the left
+ *  by choose_left_nodes() and collect_right_candidates(), while choosing
+ *  the right nodes by
+ *  choose_right_nodes(), and on the induced adjacency by
+ *  supports_two_matchings().
+ */
+static void generate_permutations(const int p1_size, const int p2_size) {
+  helper_words = ROUND_UP(p2_size, 64) / 64;
+  left_nbrs = xmalloc(p1_size * helper_words * sizeof(uint64_t));
+  cover_once = xcalloc((helper_size + 1) * helper_words, sizeof(uint64_t));
+  cover_twice = xcalloc((helper_size + 1) * helper_words, sizeof(uint64_t));
+  right_cands = xmalloc(p2_size * sizeof(int));
+  right_suffix = xmalloc(helper_size * (p2_size + 1) * sizeof(int));
+  left_degree = xmalloc(helper_size * sizeof(int));
+  fill_left_neighbors(p1_size, p2_size);
+
+  // Run through all subsets of p1_size for hp1s
+  choose_left_nodes(p1_size, 0, 0);
+
+  xfree(left_nbrs);
+  xfree(cover_once);
+  xfree(cover_twice);
+  xfree(right_cands);
+  xfree(right_suffix);
+  xfree(left_degree);
 }
 
 
@@ -931,6 +1443,22 @@ void graph_generate_perfect_matchings(graph_t *g, int up_to_size) {
   hp1s = xmalloc(up_to_size * sizeof(int));
   hp2s = xmalloc(up_to_size * sizeof(int));
   hp2os = xmalloc(up_to_size * sizeof(int));
+  group_orderings = xmalloc(up_to_size * up_to_size * sizeof(int));
+
+  // Tabulate the orderings of the sizes searched with masks
+  int ordering[MASK_MAX_SIZE];
+  const int mask_sizes = (up_to_size < MASK_MAX_SIZE) ?
+    up_to_size : MASK_MAX_SIZE;
+  int fact = 1;
+  for (int k = 2; k <= mask_sizes; k++) {
+    fact *= k;
+    for (int i = 0; i < k; i++) {
+      ordering[i] = i;
+    }
+    perm_masks[k] = xmalloc(fact * sizeof(uint64_t));
+    perm_counts[k] = 0;
+    fill_perm_masks(ordering, 0, k, perm_masks[k], &perm_counts[k]);
+  }
 
   const int partitions = g->partitions;
   for (helper_size = 2; helper_size <= up_to_size; helper_size++) {
@@ -946,30 +1474,16 @@ void graph_generate_perfect_matchings(graph_t *g, int up_to_size) {
   xfree(hp1s);
   xfree(hp2s);
   xfree(hp2os);
+  xfree(group_orderings);
 
   hp1s = NULL;
   hp2s = NULL;
   hp2os = NULL;
+  group_orderings = NULL;
 
-  // Because PMs are generated and stored for the purpose of blocking,
-  //   remove those PMs that don't have additional PMs on the same nodes
-  for (int p1 = 0; p1 < partitions; p1++) {
-    for (int p2 = p1 + 1; p2 < partitions; p2++) {
-      const int p1_size = g->partition_sizes[p1];
-      for (int n1 = 0; n1 < p1_size; n1++) {
-        if (graph_get_num_matchings(g, p1, n1, p2) > 0) {
-          matching_t *m = graph_get_first_matching(g, p1, n1, p2);
-          matching_t *prev;
-          while (m != NULL) {
-            prev = m;
-            m = graph_get_next_set(m);
-            if (graph_get_num_similar_matchings(prev) == 1) {
-              graph_remove_matching(g, p1, n1, p2, prev);
-            }
-          }
-        }
-      }
-    }
+  for (int k = 2; k <= mask_sizes; k++) {
+    xfree(perm_masks[k]);
+    perm_masks[k] = NULL;
   }
 }
 
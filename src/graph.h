@@ -48,6 +48,7 @@ typedef struct perfect_matching matching_t;
 graph_t *graph_create(int partitions, int nodes);
 graph_t *graph_create_with_sizes(int partitions, int *sizes);
 void graph_free(graph_t *g);
+void graph_clear(graph_t *g);
 
 /** Getters */
 int graph_get_num_partitions(graph_t *g);
@@ -55,11 +56,16 @@ const int *graph_get_partition_sizes(graph_t *g);
 int graph_is_edge_between(graph_t *g, int p1, int n1, int p2, int n2);
 int graph_get_num_neighbors(graph_t *g, int p1, int n1, int p2);
 int *graph_get_neighbors(graph_t *g, int p1, int n1, int p2, int *size);
+int graph_get_next_neighbor(graph_t *g, int p1, int n1, int p2, int from);
+int graph_get_next_non_neighbor(graph_t *g, int p1, int n1, int p2, int from);
+int graph_count_components(graph_t *g);
 
 int graph_get_edge_id(graph_t *g, int p1, int n1, int p2, int n2);
 
 /** Modification functions */
 void graph_add_edge(graph_t *g, int p1, int n1, int p2, int n2);
+void graph_add_edges(graph_t *g, int p1, int p2,
+    const int *n1s, const int *n2s, int count);
 void graph_remove_edge(graph_t *g, int p1, int n1, int p2, int n2);
 void graph_fully_connect_node(graph_t *g, int p1, int n1, int p2);
 void graph_fully_connect_partition(graph_t *g, int p1, int p2);
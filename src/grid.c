@@ -0,0 +1,358 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file grid.c
+ *  @brief Instance generator for mutilated boards of any shape and dimension.
+ *
+ *  Generalizes the NORMAL mutilated chessboard of mchess.c to m x n boards
+ *  and to d-dimensional grids, such as the 3D "mutilated cube": cells are
+ *  adjacent if they differ by one in one coordinate, and dominoes cover
+ *  two adjacent cells. Colors alternate as on a chessboard, by the parity
+ *  of the coordinate sum, and removing cells of one color leaves no tiling.
+ *
+ *  Cells are numbered in row-major order, the last coordinate varying
+ *  fastest, so a 2D grid of n x n cells with its corners removed gives the
+ *  same graph as mchess_generate_graph() on a NORMAL chessboard.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h> // For uint64_t
+#include <stdbool.h>
+#include <limits.h>
+
+#include "grid.h"
+#include "xmalloc.h"
+#include "graph.h"
+
+#ifndef BITS_IN_WORD
+#define BITS_IN_WORD 64
+#endif
+
+#ifndef WORD_MASK
+#define WORD_MASK    (BITS_IN_WORD - 1)
+#endif
+
+/** @brief Whether the cell with the given index is present. */
+#define IS_PRESENT(grid, c)  (((grid)->present[(c) / BITS_IN_WORD] >> ((c) & WORD_MASK)) & 0x1)
+
+
+/** @brief Defines a d-dimensional grid of cells, some of them removed.
+ *
+ *  The fields of the struct are as follows:
+ *
+ *  dims:       The number of dimensions.
+ *  sizes:      The number of cells along each dimension.
+ *  strides:    The difference in cell index between neighbors along each
+ *                dimension, so the index of a cell is the sum of its
+ *                coordinates times the strides.
+ *  cells:      The number of cells, the product of the sizes.
+ *  white:      The number of white cells present. By convention, the cell
+ *                with all coordinates 0 is white.
+ *  black:      The number of black cells present.
+ *  present:    A bitvector over cell indexes of the cells not removed.
+ *  ids:        The tile id of each present cell among the cells of its
+ *                color, or -1 for removed cells. Rebuilt lazily after
+ *                cells are removed, so lookups are constant time.
+ */
+struct mutilated_grid {
+  int dims;
+  int *sizes;
+  int *strides;
+  int cells;
+  int white;
+  int black;
+  uint64_t *present;
+  int *ids;
+  bool ids_valid;
+}; // grid_t
+
+
+/** Helper functions */
+
+/** @brief Returns the index of a cell, after checking its coordinates.
+ *
+ *  @param grid    A pointer to a grid.
+ *  @param coords  The coordinates of a cell.
+ *  @return        The index of the cell.
+ */
+static int cell_index(grid_t *grid, const int *coords) {
+  int c = 0;
+  for (int i = 0; i < grid->dims; i++) {
+    if (coords[i] < 0 || coords[i] >= grid->sizes[i]) {
+      fprintf(stderr, "Grid cell coordinate %d out of bounds\n", coords[i]);
+      exit(-1);
+    }
+    c += coords[i] * grid->strides[i];
+  }
+  return c;
+}
+
+
+/** @brief Numbers the present cells of each color in index order.
+ *
+ *  The parity of the coordinate sum is carried along as the coordinates
+ *  are counted up, so this is one pass over the cells.
+ *
+ *  @param grid  A pointer to a grid.
+ */
+static void compute_ids(grid_t *grid) {
+  int *coords = xcalloc(grid->dims, sizeof(int));
+  int next[2] = { 0, 0 };
+  int parity = 0;
+  for (int c = 0; c < grid->cells; c++) {
+    grid->ids[c] = IS_PRESENT(grid, c) ? next[parity]++ : -1;
+
+    // Count up the coordinates, last one fastest
+    for (int i = grid->dims - 1; i >= 0; i--) {
+      if (++coords[i] < grid->sizes[i]) {
+        parity ^= 1;
+        break;
+      }
+      parity ^= (grid->sizes[i] - 1) & 0x1;
+      coords[i] = 0;
+    }
+  }
+
+  xfree(coords);
+  grid->ids_valid = true;
+}
+
+
+/** Grid API */
+
+/** @brief Creates a grid with every cell present.
+ *
+ *  @param dims   The number of dimensions, at least 1.
+ *  @param sizes  The number of cells along each dimension, each at least 1.
+ *  @return       A pointer to a grid.
+ */
+grid_t *grid_create(int dims, const int *sizes) {
+  if (dims < 1) {
+    fprintf(stderr, "Grid must have at least one dimension\n");
+    exit(-1);
+  }
+
+  grid_t *grid = xmalloc(sizeof(grid_t));
+  grid->dims = dims;
+  grid->sizes = xmalloc(dims * sizeof(int));
+  grid->strides = xmalloc(dims * sizeof(int));
+  memcpy(grid->sizes, sizes, dims * sizeof(int));
+
+  long long cells = 1;
+  for (int i = dims - 1; i >= 0; i--) {
+    if (sizes[i] < 1) {
+      fprintf(stderr, "Grid dimensions must be positive\n");
+      exit(-1);
+    }
+    grid->strides[i] = (int) cells;
+    cells *= sizes[i];
+    if (cells > INT_MAX) {
+      fprintf(stderr, "Grid has too many cells\n");
+      exit(-1);
+    }
+  }
+
+  grid->cells = (int) cells;
+  grid->white = (grid->cells + 1) / 2;
+  grid->black = grid->cells / 2;
+
+  // A grid with an odd number of cells has odd sizes, so (0, ..., 0) and
+  //   the white cells are in the majority, as on a chessboard
+  const int words = (grid->cells + BITS_IN_WORD - 1) / BITS_IN_WORD;
+  grid->present = xmalloc(words * sizeof(uint64_t));
+  memset(grid->present, 0xff, words * sizeof(uint64_t));
+  if (grid->cells & WORD_MASK) {
+    grid->present[words - 1] = (1ULL << (grid->cells & WORD_MASK)) - 1;
+  }
+  grid->ids = xmalloc(grid->cells * sizeof(int));
+  grid->ids_valid = false;
+  return grid;
+}
+
+
+/** @brief Frees the memory allocated by a grid.
+ *
+ *  @param grid  A pointer to the grid to free.
+ */
+void grid_free(grid_t *grid) {
+  xfree(grid->sizes);
+  xfree(grid->strides);
+  xfree(grid->present);
+  xfree(grid->ids);
+  xfree(grid);
+}
+
+
+/** @brief Returns the number of dimensions of a grid. */
+int grid_get_dims(grid_t *grid) {
+  return grid->dims;
+}
+
+
+/** @brief Returns the number of cells along each dimension of a grid. */
+const int *grid_get_sizes(grid_t *grid) {
+  return grid->sizes;
+}
+
+
+/** @brief Returns if a cell is white, with an even coordinate sum.
+ *
+ *  @param grid    A pointer to a grid.
+ *  @param coords  The coordinates of a cell.
+ *  @return        1 if the cell is white, 0 otherwise.
+ */
+int grid_is_white(grid_t *grid, const int *coords) {
+  int sum = 0;
+  for (int i = 0; i < grid->dims; i++) {
+    sum += coords[i];
+  }
+  return sum % 2 == 0;
+}
+
+
+/** @brief Gets the id of a cell among the present cells of its color.
+ *
+ *  @param grid    A pointer to a grid.
+ *  @param coords  The coordinates of a cell.
+ *  @return        The node of the cell in its color's partition, in
+ *                 row-major order, or -1 if the cell is removed.
+ */
+int grid_get_tile_id(grid_t *grid, const int *coords) {
+  const int c = cell_index(grid, coords);
+  if (!grid->ids_valid) {
+    compute_ids(grid);
+  }
+  return grid->ids[c];
+}
+
+
+/** @brief Removes a cell from the grid.
+ *
+ *  @param grid    A pointer to a grid.
+ *  @param coords  The coordinates of a cell.
+ */
+void grid_remove_cell(grid_t *grid, const int *coords) {
+  const int c = cell_index(grid, coords);
+  if (!IS_PRESENT(grid, c)) {
+    return;
+  }
+
+  if (grid_is_white(grid, coords)) {
+    grid->white--;
+  } else {
+    grid->black--;
+  }
+
+  grid->present[c / BITS_IN_WORD] &= ~(1ULL << (c & WORD_MASK));
+  grid->ids_valid = false;
+}
+
+
+/** @brief Removes two white cells as far apart as possible.
+ *
+ *  As with the chessboard, the first is the corner (0, ..., 0), and the
+ *  second the opposite corner. When the opposite corner is black (the sum
+ *  of the sizes minus one is odd), the cell next to it in the last
+ *  dimension is removed instead. A grid with one cell loses only it.
+ *
+ *  @param grid  A pointer to a grid.
+ */
+void grid_remove_corners(grid_t *grid) {
+  int *coords = xcalloc(grid->dims, sizeof(int));
+  grid_remove_cell(grid, coords);
+
+  for (int i = 0; i < grid->dims; i++) {
+    coords[i] = grid->sizes[i] - 1;
+  }
+  const int last = grid->dims - 1;
+  if (!grid_is_white(grid, coords) && coords[last] > 0) {
+    coords[last]--;
+  }
+  if (grid_is_white(grid, coords)) {
+    grid_remove_cell(grid, coords);
+  }
+
+  xfree(coords);
+}
+
+
+/** @brief Generates a graph struct from a grid.
+ *
+ *  Each present cell is joined to its present successor along each
+ *  dimension. The coordinates are counted up alongside the cell index,
+ *  so neighbors and ids take constant time, and the edges are added to
+ *  the graph in one batch.
+ *
+ *  On memory allocation failure, exit(-1) is called.
+ *
+ *  @param grid  A pointer to a grid.
+ *  @return      A pointer to a graph structure, white cells in the 0th
+ *               partition and black cells in the 1st.
+ */
+graph_t *grid_generate_graph(grid_t *grid) {
+  int colors[2] = { grid->white, grid->black };
+  graph_t *g = graph_create_with_sizes(2, colors);
+  if (!grid->ids_valid) {
+    compute_ids(grid);
+  }
+
+  const int dims = grid->dims;
+  int *coords = xcalloc(dims, sizeof(int));
+  int *whites = xmalloc(((long long) grid->cells * dims + 1) * sizeof(int));
+  int *blacks = xmalloc(((long long) grid->cells * dims + 1) * sizeof(int));
+  int num_edges = 0;
+  int parity = 0;
+  for (int c = 0; c < grid->cells; c++) {
+    if (IS_PRESENT(grid, c)) {
+      for (int i = 0; i < dims; i++) {
+        const int next = c + grid->strides[i];
+        if (coords[i] + 1 == grid->sizes[i] || !IS_PRESENT(grid, next)) {
+          continue;
+        }
+
+        // White is 0th partition
+        whites[num_edges] = grid->ids[(parity == 0) ? c : next];
+        blacks[num_edges] = grid->ids[(parity == 0) ? next : c];
+        num_edges++;
+      }
+    }
+
+    for (int i = dims - 1; i >= 0; i--) {
+      if (++coords[i] < grid->sizes[i]) {
+        parity ^= 1;
+        break;
+      }
+      parity ^= (grid->sizes[i] - 1) & 0x1;
+      coords[i] = 0;
+    }
+  }
+
+  graph_add_edges(g, 0, 1, whites, blacks, num_edges);
+
+  xfree(coords);
+  xfree(whites);
+  xfree(blacks);
+  return g;
+}
@@ -0,0 +1,65 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file grid.h
+ *  @brief Instance generator for mutilated boards of any shape and dimension.
+ *
+ *  See grid.c for documentation and implementation details.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#ifndef _GRID_H_
+#define _GRID_H_
+
+#include "graph.h"
+
+/** @brief Defines a d-dimensional grid of cells, some of them removed.
+ *
+ *  See grid.c for struct fields and motivation.
+ */
+typedef struct mutilated_grid grid_t;
+
+
+/** Grid API
+ *
+ *  Cells are given by an array of one coordinate per dimension, each from
+ *  0 to the size of its dimension minus one.
+ */
+
+/** Creation and free functions */
+grid_t *grid_create(int dims, const int *sizes);
+void grid_free(grid_t *grid);
+
+/** Getters */
+int grid_get_dims(grid_t *grid);
+const int *grid_get_sizes(grid_t *grid);
+int grid_get_tile_id(grid_t *grid, const int *coords);
+int grid_is_white(grid_t *grid, const int *coords);
+
+/** Modification functions */
+void grid_remove_cell(grid_t *grid, const int *coords);
+void grid_remove_corners(grid_t *grid);
+
+/** Generators */
+graph_t *grid_generate_graph(grid_t *grid);
+
+#endif /* _GRID_H_ */
@@ -28,20 +28,27 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h> // For uint64_t
+#include <stdbool.h>
 #include <assert.h>
 
 #include "mchess.h"
 #include "xmalloc.h"
 #include "graph.h"
 
-#ifndef BITS_IN_BYTE
-#define BITS_IN_BYTE 8
+#ifndef BITS_IN_WORD
+#define BITS_IN_WORD 64
 #endif
 
-#ifndef BYTE_MASK
-#define BYTE_MASK    (BITS_IN_BYTE - 1)
+#ifndef WORD_MASK
+#define WORD_MASK    (BITS_IN_WORD - 1)
 #endif
 
+/** @brief Bits of a row word in even columns. Squares of one color in a
+ *         row are the squares in columns of the same parity.
+ */
+#define EVEN_COLS    0x5555555555555555ULL
+
 /** @brief Rounds x to the next multiple of y.
  *
  *  @param x The number to be rounded.
@@ -53,17 +60,17 @@
 #endif
 
 
-/** @brief Gets the char bitvector "slice" corresponding to a board position.
+/** @brief Gets the word bitvector "slice" corresponding to a board position.
  *
- *  The board squares are stored in an (n x (n / 8)) char bitvector. To index
+ *  The board squares are stored in an (n x (n / 64)) word bitvector. To index
  *  into the bitvector, the row is indexed, followed by the column divided
- *  by 8. Bitshifting is required to access within a bitvector "slice."
+ *  by 64. Bitshifting is required to access within a bitvector "slice."
  *
  *  @param mc  A pointer to a mutilated chessboard.
  *  @param p   A position on the chessboard.
- *  @return    The char containing the bit for that row and column.
+ *  @return    The word containing the bit for that row and column.
  */
-#define BOARD(mc, p)      ((mc->squares)[(p)->row][(p)->col / BITS_IN_BYTE])
+#define BOARD(mc, p)      ((mc->squares)[(p)->row][(p)->col / BITS_IN_WORD])
 
 
 /** @brief Gets the "present" bit corresponding to a board position.
@@ -75,7 +82,7 @@
  *  @param p   A position on the chessboard.
  *  @return    1 if the square at p is present, 0 otherwise.
  */
-#define GET_BIT(mc, p)    ((BOARD(mc, p) >> ((p)->col & BYTE_MASK)) & 0x1)
+#define GET_BIT(mc, p)    ((BOARD(mc, p) >> ((p)->col & WORD_MASK)) & 0x1)
 
 
 /** @brief Sets the "present" bit at the specified board position to 1.
@@ -86,7 +93,7 @@
  *  @param mc  A pointer to a mutilated chessboard.
  *  @param p   A position on the chessboard.
  */
-#define SET_BIT(mc, p)    (BOARD(mc, p) |= (0x1 << ((p)->col & BYTE_MASK)))
+#define SET_BIT(mc, p)    (BOARD(mc, p) |= (1ULL << ((p)->col & WORD_MASK)))
 
 
 /** @brief Sets the "present" bit at the specified board position to 0.
@@ -97,7 +104,7 @@
  *  @param mc  A pointer to a mutilated chessboard.
  *  @param p   A position on the chessboard.
  */
-#define CLEAR_BIT(mc, p)  (BOARD(mc, p) &= ~(0x1 << ((p)->col & BYTE_MASK)))
+#define CLEAR_BIT(mc, p)  (BOARD(mc, p) &= ~(1ULL << ((p)->col & WORD_MASK)))
 
 
 /** @brief Returns if the position is white or black.
@@ -127,6 +134,10 @@ typedef enum neighbor {
   LEFT, RIGHT, UP, DOWN
 } neigh_t;
 
+/** @brief Row and column offsets of each direction, indexed by neigh_t. */
+static const int neigh_rows[] = { 0, 0, -1, 1 };
+static const int neigh_cols[] = { -1, 1, 0, 0 };
+
 
 /** @brief Defines a mutilated chessboard.
  *
@@ -151,16 +162,29 @@ typedef enum neighbor {
  *             white will have fewer squares than black.
  *  black:   The number of black squares on the board. Roughly half n^2.
  *  variant: The geometry of the board.
+ *  wrap_cols: Whether the first and last columns are neighbors.
+ *  wrap_rows: Whether the first and last rows are neighbors.
+ *  words:   The number of words in each row of squares.
  *  squares: A 2D bitvector representing whether the squares are present.
  *           A typical mutilated chessboard only has two squares missing,
- *           so in most cases, a majority of the bits are set to 1.
+ *           so in most cases, a majority of the bits are set to 1. Bits
+ *           past column n - 1 are always 0.
+ *  ranks:   For each row, word of the row, and color (white first), the
+ *           number of present squares of that color before the word, in
+ *           row-major order. Gives tile ids in constant time. Rebuilt
+ *           lazily after squares are added or removed.
  */
 struct mutilated_chessboard {
   unsigned int n;
   unsigned int white;
   unsigned int black;
   mchess_variant_t variant;
-  char **squares;
+  bool wrap_cols;
+  bool wrap_rows;
+  unsigned int words;
+  uint64_t **squares;
+  int *ranks;
+  bool ranks_valid;
 }; // mchess_t;
 
 
@@ -193,92 +217,73 @@ static void check_mchess_args(mchess_t *mc, mchess_pos_t *pos) {
  */
 static void get_neighbor(mchess_t *mc, 
     mchess_pos_t *pos, neigh_t neigh, mchess_pos_t *n_pos) {
-  // Neighbor position will only adjust by 1 from here, in most cases
-  n_pos->row = pos->row;
-  n_pos->col = pos->col;
-
-  // Leave special cases to the end
-  if (neigh == LEFT && pos->col == 0) {
-    switch (mc->variant) {
-      case NORMAL:
-        n_pos->row = BAD_POS;
-        n_pos->col = BAD_POS;
-        break;
-      case CYLINDER:
-      case TORUS:
-        n_pos->col = mc->n - 1;
-        break;
-      default:
-        UNRECOGNIZED_ENUM;
-    }
-  } else if (neigh == RIGHT && pos->col == mc->n - 1) {
-    switch (mc->variant) {
-      case NORMAL:
-        n_pos->row = BAD_POS;
-        n_pos->col = BAD_POS;
-        break;
-      case CYLINDER:
-      case TORUS:
-        n_pos->col = 0;
-        break;
-      default:
-        UNRECOGNIZED_ENUM;
-    }
-  } else if (neigh == UP && pos->row == 0) {
-    switch (mc->variant) {
-      case NORMAL:
-      case CYLINDER:
-        n_pos->row = BAD_POS;
-        n_pos->col = BAD_POS;
-        break;
-      case TORUS:
-        n_pos->row = mc->n - 1;
-        break;
-      default:
-        UNRECOGNIZED_ENUM;
-    }
-  } else if (neigh == DOWN && pos->row == mc->n - 1) {
-    switch (mc->variant) {
-      case NORMAL:
-      case CYLINDER:
-        n_pos->row = BAD_POS;
-        n_pos->col = BAD_POS;
-        break;
-      case TORUS:
-        n_pos->row = 0;
-        break;
-      default:
-        UNRECOGNIZED_ENUM;
-    }
+  const int n = mc->n;
+  int row = (int) pos->row + neigh_rows[neigh];
+  int col = (int) pos->col + neigh_cols[neigh];
+
+  // Off the board, unless that side wraps around
+  if ((col < 0 || col >= n) && !mc->wrap_cols) {
+    row = col = BAD_POS;
+  } else if ((row < 0 || row >= n) && !mc->wrap_rows) {
+    row = col = BAD_POS;
   } else {
-    // Slightly change the position's coordinates depending on neighbor
-    switch (neigh) {
-      case LEFT:
-        n_pos->col--;
-        break;
-      case RIGHT:
-        n_pos->col++;
-        break;
-      case UP:
-        n_pos->row--;
-        break;
-      case DOWN:
-        n_pos->row++;
-        break;
-      default:
-        UNRECOGNIZED_ENUM;
+    row = (row + n) % n;
+    col = (col + n) % n;
+  }
+
+  n_pos->row = row;
+  n_pos->col = col;
+}
+
+
+/** @brief Counts the present squares of each color before each row word.
+ *
+ *  @param mc  A pointer to a chessboard.
+ */
+static void compute_ranks(mchess_t *mc) {
+  const int n = mc->n;
+  const int words = mc->words;
+  int count[2] = { 0, 0 };
+  for (int row = 0; row < n; row++) {
+    // White squares are in even columns on even rows
+    const uint64_t white = (row % 2 == 0) ? EVEN_COLS : ~EVEN_COLS;
+    for (int i = 0; i < words; i++) {
+      mc->ranks[2 * (row * words + i)] = count[0];
+      mc->ranks[2 * (row * words + i) + 1] = count[1];
+      count[0] += __builtin_popcountll(mc->squares[row][i] & white);
+      count[1] += __builtin_popcountll(mc->squares[row][i] & ~white);
     }
   }
+  mc->ranks_valid = true;
+}
+
+
+/** @brief Returns the tile id of a present square, in constant time.
+ *
+ *  The ranks must be valid. Squares of one color in a row share the parity
+ *  of their column, so the id adds the present squares of that parity
+ *  before the column in its word to the rank of the word.
+ *
+ *  @param mc   A pointer to a chessboard.
+ *  @param row  The row of the square.
+ *  @param col  The column of the square.
+ *  @return     The id of the square among the present squares of its color.
+ */
+static inline int tile_rank(mchess_t *mc, int row, int col) {
+  const int i = col / BITS_IN_WORD;
+  const int color = (row + col) % 2;
+  const uint64_t parity = (col % 2 == 0) ? EVEN_COLS : ~EVEN_COLS;
+  const uint64_t before = (1ULL << (col & WORD_MASK)) - 1;
+  return mc->ranks[2 * (row * mc->words + i) + color] +
+    __builtin_popcountll(mc->squares[row][i] & parity & before);
 }
 
 
 /** @brief Gets the index for the tile.
  *
  *  Is a translator to graph_t struct, so different positions, one black and
- *  one white, can return the same value.
- *
- *  TODO currently inefficient, can make this O(n) instead of O(n^2)
- *  Or even O(1)
+ *  one white, can return the same value. Constant time, once the ranks are
+ *  computed after the last change to the board.
  *
  *  @param mc   A pointer to a chessboard.
  *  @param pos  A pointer to a position.
@@ -291,31 +296,10 @@ int mchess_get_tile_id(mchess_t *mc, mchess_pos_t *pos) {
     return -1;
   }
 
-  const int n = mc->n;
-  const int prow = pos->row;
-  const int pcol = pos->col;
-  const int iswhite = IS_WHITE(pos);
-
-  // Scan from top-left to bottom right, tallying up similar present colors
-  int id = 0;
-  for (int row = 0; row < n; row++) {
-    for (int col = 0; col < n; col++) {
-      mchess_pos_t scan_pos;
-      scan_pos.row = row;
-      scan_pos.col = col;
-
-      // If same color, either return id or add one if present
-      if (IS_WHITE(&scan_pos) == iswhite) {
-        if (prow == row && pcol == col) {
-          return id;
-        } else if (GET_BIT(mc, &scan_pos)) {
-          id++;
-        }
-      }
-    }
+  if (!mc->ranks_valid) {
+    compute_ranks(mc);
   }
-
-  return id;
+  return tile_rank(mc, pos->row, pos->col);
 }
 
 
@@ -369,6 +353,7 @@ void mchess_add_square(mchess_t *mc, mchess_pos_t *pos) {
   }
 
   SET_BIT(mc, pos);
+  mc->ranks_valid = false;
 }
 
 
@@ -395,6 +380,7 @@ void mchess_remove_square(mchess_t *mc, mchess_pos_t *pos) {
   }
 
   CLEAR_BIT(mc, pos);
+  mc->ranks_valid = false;
 }
 
 
@@ -433,14 +419,20 @@ mchess_t *mchess_create(int n, mchess_variant_t variant) {
   mc->white = (n * n + 1) / 2;
   mc->black = (n * n) / 2;
   mc->variant = variant;
-  mc->squares = xmalloc(n * sizeof(char *));
+  mc->squares = xmalloc(n * sizeof(uint64_t *));
 
-  // Bitvector size is basically n / BITS_IN_BYTE, modulo some rounding
-  const int bv_size = ROUND_UP(n, BITS_IN_BYTE) / BITS_IN_BYTE;
+  // Bitvector size is basically n / BITS_IN_WORD, modulo some rounding
+  const int bv_size = ROUND_UP(n, BITS_IN_WORD) / BITS_IN_WORD;
+  mc->words = bv_size;
   for (int i = 0; i < n; i++) {
-    mc->squares[i] = xmalloc(bv_size * sizeof(char));
-    memset(mc->squares[i], 0xff, bv_size * sizeof(char)); // Set squares to 1
+    mc->squares[i] = xmalloc(bv_size * sizeof(uint64_t));
+    memset(mc->squares[i], 0xff, bv_size * sizeof(uint64_t)); // Set squares to 1
+    if (n & WORD_MASK) {
+      mc->squares[i][bv_size - 1] = (1ULL << (n & WORD_MASK)) - 1;
+    }
   }
+  mc->ranks = xmalloc(2 * n * bv_size * sizeof(int) + sizeof(int));
+  mc->ranks_valid = false;
 
   // Drop first square, always top-left corner
   mchess_pos_t first_square;
@@ -455,16 +447,22 @@ mchess_t *mchess_create(int n, mchess_variant_t variant) {
       // Remove bottom right corner
       second_square.row = n - 1;
       second_square.col = n - 1;
+      mc->wrap_cols = false;
+      mc->wrap_rows = false;
       break;
     case CYLINDER:
       // Remove bottom-middle edge square
       second_square.row = n - 1;
       second_square.col = n / 2;
+      mc->wrap_cols = true;
+      mc->wrap_rows = false;
       break;
     case TORUS:
       // Remove middle square
       second_square.row = n / 2;
       second_square.col = n / 2;
+      mc->wrap_cols = true;
+      mc->wrap_rows = true;
       break;
     default:
       UNRECOGNIZED_ENUM;
@@ -502,6 +500,7 @@ void mchess_free(mchess_t *mc) {
   }
 
   xfree(mc->squares);
+  xfree(mc->ranks);
   xfree(mc);
 }
 
@@ -577,6 +576,41 @@ mchess_pos_t *mchess_get_neighbors(mchess_t *mc, mchess_pos_t *pos, int *len) {
 }
 
 
+/** @brief Adds the edges between pairs of present squares.
+ *
+ *  Each bit set in pairs, at column col of row, pairs that square with the
+ *  square at (row2, col + dcol), wrapping around the columns.
+ *
+ *  @param g      A pointer to the graph structure.
+ *  @param mc     A pointer to a mutilated chessboard, with valid ranks.
+ *  @param pairs  A row bitvector of the first square of each pair.
+ *  @param row    The row of the first squares.
+ *  @param row2   The row of the second squares.
+ *  @param dcol   The column offset of the second squares.
+ */
+static void add_edges(graph_t *g, mchess_t *mc, const uint64_t *pairs,
+    int row, int row2, int dcol) {
+  const int n = mc->n;
+  for (int i = 0; i < mc->words; i++) {
+    uint64_t word = pairs[i];
+    while (word != 0) {
+      const int col = i * BITS_IN_WORD + __builtin_ctzll(word);
+      const int col2 = (col + dcol) % n;
+      word &= word - 1;
+
+      // White is 0th partition
+      const int id = tile_rank(mc, row, col);
+      const int neigh_id = tile_rank(mc, row2, col2);
+      if ((row + col) % 2 == 0) {
+        graph_add_edge(g, 0, id, 1, neigh_id);
+      } else {
+        graph_add_edge(g, 0, neigh_id, 1, id);
+      }
+    }
+  }
+}
+
+
 /** @brief Generates a graph struct from a mutilated chessboard.
  *
  *  Board variants map to edges in the natural way.
@@ -585,6 +619,13 @@ mchess_pos_t *mchess_get_neighbors(mchess_t *mc, mchess_pos_t *pos, int *len) {
  *  are touching, then the edge is not added to the graph. As a result, an
  *  even number for n is advised.
  *
+ *  The edges are found a row at a time with word operations: squares with
+ *  a present right neighbor are the row ANDed with itself shifted by one
+ *  column (the first column moving to the last on a CYLINDER or TORUS),
+ *  and squares with a present neighbor below are the row ANDed with the
+ *  next (on a TORUS, the last row with the first). Tile ids take constant
+ *  time, so this is linear in the area of the board.
+ *
  *  On memory allocation failure, exit(-1) is called.
  *
  *  @param mc  A pointer to a mutilated chessboard.
@@ -595,44 +636,42 @@ graph_t *mchess_generate_graph(mchess_t *mc) {
   // By convention, white is the 0th partition, black the 1st
   int colors[2] = { mc->white, mc->black };
   graph_t *g = graph_create_with_sizes(2, colors);
+  if (!mc->ranks_valid) {
+    compute_ranks(mc);
+  }
 
-  // Add in edges for neighbors
+  // Wrapped neighbors on an odd board have the same color, so get no edge
   const int n = mc->n;
-  int len;
-  mchess_pos_t pos;
+  const int words = mc->words;
+  const int last = n - 1;
+  const bool wrap_cols = mc->wrap_cols && n % 2 == 0;
+  const bool wrap_rows = mc->wrap_rows && n % 2 == 0;
+  uint64_t *pairs = xmalloc(words * sizeof(uint64_t));
   for (int row = 0; row < n; row++) {
-    for (int col = 0; col < n; col++) {
-      pos.row = row;
-      pos.col = col;
+    const uint64_t *cur = mc->squares[row];
 
-      if (GET_BIT(mc, &pos) == 0) {
-        continue;
-      }
+    // Right neighbors
+    for (int i = 0; i < words; i++) {
+      const uint64_t next = (i + 1 < words) ? cur[i + 1] << WORD_MASK : 0;
+      pairs[i] = cur[i] & ((cur[i] >> 1) | next);
+    }
+    if (wrap_cols) {
+      pairs[last / BITS_IN_WORD] |=
+        (cur[last / BITS_IN_WORD] >> (last & WORD_MASK) & cur[0] & 0x1)
+        << (last & WORD_MASK);
+    }
+    add_edges(g, mc, pairs, row, row, 1);
 
-      // Half are white, half are black
-      int id = mchess_get_tile_id(mc, &pos);
-
-      // For each neighbor, add an edge
-      mchess_pos_t *neighbors = mchess_get_neighbors(mc, &pos, &len);
-      for (int i = 0; i < len; i++) {
-        int neigh_id = mchess_get_tile_id(mc, &neighbors[i]);
-
-        // Skip squares of the same color
-        if (IS_WHITE(&pos) == IS_WHITE(&neighbors[i])) {
-          continue;
-        }
-
-        // White is 0th partition
-        if (IS_WHITE(&pos)) {
-          graph_add_edge(g, 0, id, 1, neigh_id);
-        } else {
-          graph_add_edge(g, 0, neigh_id, 1, id);
-        }
+    // Neighbors below
+    if (row < last || wrap_rows) {
+      const int row2 = (row + 1) % n;
+      for (int i = 0; i < words; i++) {
+        pairs[i] = cur[i] & mc->squares[row2][i];
       }
-
-      xfree(neighbors);
+      add_edges(g, mc, pairs, row, row2, 0);
     }
   }
 
+  xfree(pairs);
   return g;
 }
@@ -0,0 +1,814 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file ordering.c
+ *  @brief Heuristic BDD variable orders for a CNF formula.
+ *
+ *  The default PGBDD orders written by bipartgen are fixed traversals of
+ *  the graph. BDD sizes are very sensitive to the order, and a common
+ *  proxy is how far apart the variables of each clause end up. The
+ *  heuristics here work on the interaction graph of the formula, where
+ *  two variables are adjacent if they occur in a clause together:
+ *
+ *    - Reverse Cuthill-McKee, which keeps adjacent variables close by
+ *      breadth-first search from a peripheral variable (low bandwidth).
+ *    - Min-fill, which greedily picks the variable whose elimination adds
+ *      the fewest new edges among its neighbors (low induced width). Only
+ *      the neighbors of an eliminated variable have their scores updated,
+ *      and dense variables use a bound, so the fill counts are approximate.
+ *    - Bounded sifting, a local search that moves each variable up to a
+ *      window of positions by adjacent swaps, keeping the best position
+ *      for the clause-span cost below.
+ *
+ *  The clause-span cost of an order is the sum, over clauses, of the
+ *  distance between the first and last variable of the clause.
+ *
+ *  Any order can also be read as an elimination order, first variable
+ *  first, for bucket elimination: each clause goes in the bucket of its
+ *  first eliminated variable, and the induced width bounds the size of
+ *  the intermediate functions (and the tree width of the formula).
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "ordering.h"
+#include "xmalloc.h"
+
+/** @brief Beyond this degree, min-fill uses the bound d(d - 1)/2 instead of
+ *         counting, since counting costs about d times the neighbor degrees.
+ *         Once the chosen variable is beyond it, the rest are taken in the
+ *         current heap order without eliminating them.
+ */
+#define FILL_COUNT_LIMIT   64
+
+/** @brief A graph in compressed sparse row form, over variables 1..n.
+ *
+ *  The neighbors of v are adj[start[v]] .. adj[start[v + 1] - 1].
+ */
+typedef struct csr_graph {
+  int n;
+  int *start;
+  int *adj;
+} csr_t;
+
+
+/** Helper functions */
+
+/** @brief Builds the clauses containing each variable.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @return     A CSR structure whose rows list clause indexes.
+ */
+static csr_t build_occurrences(cnf_t *cnf) {
+  const int n = cnf_get_num_vars(cnf);
+  const int num_clauses = cnf_get_num_clauses(cnf);
+  csr_t occ;
+  occ.n = n;
+  occ.start = xcalloc(n + 2, sizeof(int));
+
+  for (int c = 0; c < num_clauses; c++) {
+    int size;
+    const int *lits = cnf_get_clause(cnf, c, &size);
+    for (int i = 0; i < size; i++) {
+      occ.start[abs(lits[i]) + 1]++;
+    }
+  }
+  for (int v = 1; v <= n + 1; v++) {
+    occ.start[v] += occ.start[v - 1];
+  }
+
+  occ.adj = xmalloc((occ.start[n + 1] + 1) * sizeof(int));
+  int *fill = xmalloc((n + 1) * sizeof(int));
+  memcpy(fill, occ.start, (n + 1) * sizeof(int));
+  for (int c = 0; c < num_clauses; c++) {
+    int size;
+    const int *lits = cnf_get_clause(cnf, c, &size);
+    for (int i = 0; i < size; i++) {
+      occ.adj[fill[abs(lits[i])]++] = c;
+    }
+  }
+
+  xfree(fill);
+  return occ;
+}
+
+
+/** @brief Builds the interaction graph of a formula, without repeats.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @return     A CSR structure whose rows list adjacent variables.
+ */
+static csr_t build_interactions(cnf_t *cnf) {
+  const int n = cnf_get_num_vars(cnf);
+  csr_t occ = build_occurrences(cnf);
+  csr_t g;
+  g.n = n;
+  g.start = xmalloc((n + 2) * sizeof(int));
+
+  int *stamp = xcalloc(n + 1, sizeof(int));
+  int cap = 1024, len = 0;
+  g.adj = xmalloc(cap * sizeof(int));
+  for (int v = 1; v <= n; v++) {
+    g.start[v] = len;
+    stamp[v] = v;
+    for (int o = occ.start[v]; o < occ.start[v + 1]; o++) {
+      int size;
+      const int *lits = cnf_get_clause(cnf, occ.adj[o], &size);
+      for (int i = 0; i < size; i++) {
+        const int u = abs(lits[i]);
+        if (stamp[u] == v) {
+          continue;
+        }
+
+        stamp[u] = v;
+        if (len == cap) {
+          cap *= 2;
+          g.adj = xrealloc(g.adj, cap * sizeof(int));
+        }
+        g.adj[len++] = u;
+      }
+    }
+  }
+  g.start[0] = 0;
+  g.start[n + 1] = len;
+
+  xfree(stamp);
+  xfree(occ.start);
+  xfree(occ.adj);
+  return g;
+}
+
+
+/** @brief Frees the arrays of a CSR structure. */
+static void free_csr(csr_t *g) {
+  xfree(g->start);
+  xfree(g->adj);
+}
+
+
+/** @brief Returns the degree of v in a CSR graph. */
+static inline int degree(const csr_t *g, int v) {
+  return g->start[v + 1] - g->start[v];
+}
+
+
+/** @brief The graph whose degrees order variables in by_degree(). */
+static const csr_t *sort_graph = NULL;
+
+/** @brief qsort() comparator: increasing degree in sort_graph, then
+ *         increasing variable, so that results do not depend on qsort.
+ */
+static int by_degree(const void *a, const void *b) {
+  const int u = *(const int *) a, v = *(const int *) b;
+  const int du = degree(sort_graph, u), dv = degree(sort_graph, v);
+  if (du != dv) {
+    return (du < dv) ? -1 : 1;
+  }
+  return (u > v) - (u < v);
+}
+
+
+/** @brief Breadth-first search from root over unvisited variables.
+ *
+ *  Neighbors are visited in order of increasing degree, as Cuthill-McKee
+ *  requires. Visited variables are appended to queue from index head.
+ *
+ *  @return  The index one past the last variable appended.
+ */
+static int bfs(const csr_t *g, int root, int *queue, int head,
+    bool *visited, int *level) {
+  int tail = head;
+  queue[tail++] = root;
+  visited[root] = true;
+  if (level != NULL) {
+    level[root] = 0;
+  }
+
+  while (head < tail) {
+    const int v = queue[head++];
+    const int first = tail;
+    for (int i = g->start[v]; i < g->start[v + 1]; i++) {
+      const int u = g->adj[i];
+      if (!visited[u]) {
+        visited[u] = true;
+        if (level != NULL) {
+          level[u] = level[v] + 1;
+        }
+        queue[tail++] = u;
+      }
+    }
+
+    sort_graph = g;
+    qsort(queue + first, tail - first, sizeof(int), by_degree);
+  }
+
+  return tail;
+}
+
+
+/** @brief Computes the clause-span of one clause under positions pos. */
+static inline int clause_span(cnf_t *cnf, int c, const int *pos) {
+  int size;
+  const int *lits = cnf_get_clause(cnf, c, &size);
+  int lo = pos[abs(lits[0])], hi = lo;
+  for (int i = 1; i < size; i++) {
+    const int p = pos[abs(lits[i])];
+    lo = (p < lo) ? p : lo;
+    hi = (p > hi) ? p : hi;
+  }
+  return hi - lo;
+}
+
+
+/** Ordering API */
+
+/** @brief Makes an order from a list of variables.
+ *
+ *  Keeps the first occurrence of each variable in range, then appends the
+ *  variables that were not listed, in increasing order. Useful to start
+ *  from an order file that may repeat or miss variables.
+ *
+ *  @param vars      The list of variables.
+ *  @param size      The length of vars.
+ *  @param num_vars  The number of variables in the formula.
+ *  @return          A permutation of 1..num_vars.
+ */
+int *ordering_from_list(const int *vars, int size, int num_vars) {
+  int *order = xmalloc((num_vars + 1) * sizeof(int));
+  bool *seen = xcalloc(num_vars + 1, sizeof(bool));
+  int len = 0;
+  for (int i = 0; i < size; i++) {
+    const int v = abs(vars[i]);
+    if (1 <= v && v <= num_vars && !seen[v]) {
+      seen[v] = true;
+      order[len++] = v;
+    }
+  }
+  for (int v = 1; v <= num_vars; v++) {
+    if (!seen[v]) {
+      order[len++] = v;
+    }
+  }
+
+  xfree(seen);
+  return order;
+}
+
+
+/** @brief Computes a reverse Cuthill-McKee order.
+ *
+ *  Each connected component is started from a pseudo-peripheral variable,
+ *  found by repeating the search from the last, lowest-degree variable
+ *  of the deepest level while the depth grows.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @return     A permutation of 1..num_vars.
+ */
+int *ordering_rcm(cnf_t *cnf) {
+  const int n = cnf_get_num_vars(cnf);
+  csr_t g = build_interactions(cnf);
+  int *order = xmalloc((n + 1) * sizeof(int));
+  int *scratch = xmalloc((n + 1) * sizeof(int));
+  int *level = xmalloc((n + 1) * sizeof(int));
+  bool *visited = xcalloc(n + 1, sizeof(bool));
+  bool *probe = xcalloc(n + 1, sizeof(bool));
+
+  int len = 0;
+  for (int v = 1; v <= n; v++) {
+    if (visited[v]) {
+      continue;
+    }
+
+    // Find a pseudo-peripheral root of v's component
+    int root = v, depth = -1;
+    while (true) {
+      int end = bfs(&g, root, scratch, 0, probe, level);
+      const int last = scratch[end - 1];
+      int best = last;
+      for (int i = end - 1; i >= 0 && level[scratch[i]] == level[last]; i--) {
+        if (degree(&g, scratch[i]) < degree(&g, best)) {
+          best = scratch[i];
+        }
+      }
+      for (int i = 0; i < end; i++) {
+        probe[scratch[i]] = false;
+      }
+
+      if (level[last] <= depth) {
+        break;
+      }
+      depth = level[last];
+      root = best;
+    }
+
+    len = bfs(&g, root, order, len, visited, NULL);
+  }
+
+  // Reverse
+  for (int i = 0, j = n - 1; i < j; i++, j--) {
+    const int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  xfree(probe);
+  xfree(visited);
+  xfree(level);
+  xfree(scratch);
+  free_csr(&g);
+  return order;
+}
+
+
+/** @brief Growable adjacency lists for elimination.
+ *
+ *  Eliminated variables are dropped from a list lazily, by compact().
+ */
+typedef struct elimination_graph {
+  int **adj;
+  int *deg;
+  int *cap;
+  bool *gone;
+  int *stamp;
+  int clock;
+} elim_t;
+
+
+/** @brief Drops eliminated variables from the adjacency list of v. */
+static void compact(elim_t *e, int v) {
+  int k = 0;
+  for (int i = 0; i < e->deg[v]; i++) {
+    if (!e->gone[e->adj[v][i]]) {
+      e->adj[v][k++] = e->adj[v][i];
+    }
+  }
+  e->deg[v] = k;
+}
+
+
+/** @brief Counts the pairs of neighbors of v that are not adjacent. */
+static int count_fill(elim_t *e, int v) {
+  compact(e, v);
+  if (e->deg[v] > FILL_COUNT_LIMIT) {
+    return e->deg[v] * (e->deg[v] - 1) / 2;
+  }
+
+  int f = 0;
+  for (int i = 0; i < e->deg[v]; i++) {
+    const int a = e->adj[v][i];
+    compact(e, a);
+    e->clock++;
+    for (int j = 0; j < e->deg[a]; j++) {
+      e->stamp[e->adj[a][j]] = e->clock;
+    }
+    for (int j = i + 1; j < e->deg[v]; j++) {
+      f += (e->stamp[e->adj[v][j]] != e->clock);
+    }
+  }
+  return f;
+}
+
+
+/** @brief Min-heap of variables keyed by (fill, degree, variable). */
+typedef struct fill_heap {
+  int *heap;
+  int *idx;
+  int size;
+  const int *fill;
+  const int *deg;
+} fill_heap_t;
+
+
+/** @brief Whether u should be eliminated before v. */
+static inline bool heap_less(fill_heap_t *h, int u, int v) {
+  if (h->fill[u] != h->fill[v]) return h->fill[u] < h->fill[v];
+  if (h->deg[u] != h->deg[v]) return h->deg[u] < h->deg[v];
+  return u < v;
+}
+
+
+/** @brief Restores the heap property around index i. */
+static void heap_fix(fill_heap_t *h, int i) {
+  const int v = h->heap[i];
+  while (i > 0 && heap_less(h, v, h->heap[(i - 1) / 2])) {
+    h->heap[i] = h->heap[(i - 1) / 2];
+    h->idx[h->heap[i]] = i;
+    i = (i - 1) / 2;
+  }
+  while (true) {
+    int c = 2 * i + 1;
+    if (c >= h->size) {
+      break;
+    }
+    if (c + 1 < h->size && heap_less(h, h->heap[c + 1], h->heap[c])) {
+      c++;
+    }
+    if (!heap_less(h, h->heap[c], v)) {
+      break;
+    }
+    h->heap[i] = h->heap[c];
+    h->idx[h->heap[i]] = i;
+    i = c;
+  }
+  h->heap[i] = v;
+  h->idx[v] = i;
+}
+
+
+/** @brief Computes a greedy min-fill elimination order.
+ *
+ *  The first variable of the order is eliminated first. Ties are broken
+ *  by lower degree, then by lower variable.
+ *
+ *  @param cnf  A pointer to a formula.
+ *  @return     A permutation of 1..num_vars.
+ */
+int *ordering_min_fill(cnf_t *cnf) {
+  const int n = cnf_get_num_vars(cnf);
+  csr_t g = build_interactions(cnf);
+
+  elim_t e;
+  e.adj = xmalloc((n + 1) * sizeof(int *));
+  e.deg = xcalloc(n + 1, sizeof(int));
+  e.cap = xmalloc((n + 1) * sizeof(int));
+  e.gone = xcalloc(n + 1, sizeof(bool));
+  e.stamp = xcalloc(n + 1, sizeof(int));
+  e.clock = 0;
+  for (int v = 1; v <= n; v++) {
+    e.deg[v] = degree(&g, v);
+    e.cap[v] = (e.deg[v] < 4) ? 4 : e.deg[v];
+    e.adj[v] = xmalloc(e.cap[v] * sizeof(int));
+    memcpy(e.adj[v], g.adj + g.start[v], e.deg[v] * sizeof(int));
+  }
+  free_csr(&g);
+
+  int *fill = xmalloc((n + 1) * sizeof(int));
+  fill_heap_t h;
+  h.heap = xmalloc((n + 1) * sizeof(int));
+  h.idx = xmalloc((n + 1) * sizeof(int));
+  h.size = 0;
+  h.fill = fill;
+  h.deg = e.deg;
+  for (int v = 1; v <= n; v++) {
+    fill[v] = count_fill(&e, v);
+    h.heap[h.size] = v;
+    h.idx[v] = h.size++;
+    heap_fix(&h, h.size - 1);
+  }
+
+  int *order = xmalloc((n + 1) * sizeof(int));
+  bool dense = false;
+  for (int step = 0; step < n; step++) {
+    const int best = h.heap[0];
+    order[step] = best;
+    e.gone[best] = true;
+    h.heap[0] = h.heap[--h.size];
+    h.idx[h.heap[0]] = 0;
+    if (h.size > 0) {
+      heap_fix(&h, 0);
+    }
+
+    dense |= (e.deg[best] > FILL_COUNT_LIMIT);
+    if (dense) {
+      continue;
+    }
+
+    // Connect the neighbors of best, then rescore them
+    compact(&e, best);
+    for (int i = 0; i < e.deg[best]; i++) {
+      const int a = e.adj[best][i];
+      compact(&e, a);
+      e.clock++;
+      for (int j = 0; j < e.deg[a]; j++) {
+        e.stamp[e.adj[a][j]] = e.clock;
+      }
+      for (int j = 0; j < e.deg[best]; j++) {
+        const int b = e.adj[best][j];
+        if (b == a || e.stamp[b] == e.clock) {
+          continue;
+        }
+
+        if (e.deg[a] == e.cap[a]) {
+          e.cap[a] *= 2;
+          e.adj[a] = xrealloc(e.adj[a], e.cap[a] * sizeof(int));
+        }
+        e.adj[a][e.deg[a]++] = b;
+      }
+    }
+    for (int i = 0; i < e.deg[best]; i++) {
+      const int a = e.adj[best][i];
+      fill[a] = count_fill(&e, a);
+      heap_fix(&h, h.idx[a]);
+    }
+  }
+
+  for (int v = 1; v <= n; v++) {
+    xfree(e.adj[v]);
+  }
+  xfree(e.adj);
+  xfree(e.deg);
+  xfree(e.cap);
+  xfree(e.gone);
+  xfree(e.stamp);
+  xfree(h.heap);
+  xfree(h.idx);
+  xfree(fill);
+  return order;
+}
+
+
+/** @brief Returns the clause-span cost of an order.
+ *
+ *  @param cnf    A pointer to a formula.
+ *  @param order  A permutation of 1..num_vars.
+ *  @return       The sum over clauses of the distance between the first
+ *                and last of its variables in the order.
+ */
+long long ordering_span_cost(cnf_t *cnf, const int *order) {
+  const int n = cnf_get_num_vars(cnf);
+  int *pos = xmalloc((n + 1) * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    pos[order[i]] = i;
+  }
+
+  long long cost = 0;
+  const int num_clauses = cnf_get_num_clauses(cnf);
+  for (int c = 0; c < num_clauses; c++) {
+    cost += clause_span(cnf, c, pos);
+  }
+
+  xfree(pos);
+  return cost;
+}
+
+
+/** @brief Swaps the variables at positions p and p + 1 of an order.
+ *
+ *  Only clauses containing one of the two variables change span; stamp
+ *  marks those of the first so a clause with both is counted once.
+ *
+ *  @param cnf    A pointer to a formula.
+ *  @param occ    The clauses of each variable.
+ *  @param order  The order, updated in place.
+ *  @param pos    The position of each variable in order, updated in place.
+ *  @param stamp  A clause stamp per clause, below *clock.
+ *  @param clock  The last stamp used, advanced by one.
+ *  @param p      The position of the first variable.
+ *  @return       The change in clause-span cost.
+ */
+static inline long long sift_swap(cnf_t *cnf, const csr_t *occ, int *order,
+    int *pos, int *stamp, int *clock, int p) {
+  const int a = order[p], b = order[p + 1];
+  long long before = 0, after = 0;
+  const int now = ++(*clock);
+  for (int o = occ->start[a]; o < occ->start[a + 1]; o++) {
+    stamp[occ->adj[o]] = now;
+    before += clause_span(cnf, occ->adj[o], pos);
+  }
+  for (int o = occ->start[b]; o < occ->start[b + 1]; o++) {
+    if (stamp[occ->adj[o]] != now) {
+      before += clause_span(cnf, occ->adj[o], pos);
+    }
+  }
+  order[p] = b;
+  order[p + 1] = a;
+  pos[b] = p;
+  pos[a] = p + 1;
+  for (int o = occ->start[a]; o < occ->start[a + 1]; o++) {
+    after += clause_span(cnf, occ->adj[o], pos);
+  }
+  for (int o = occ->start[b]; o < occ->start[b + 1]; o++) {
+    if (stamp[occ->adj[o]] != now) {
+      after += clause_span(cnf, occ->adj[o], pos);
+    }
+  }
+  return after - before;
+}
+
+
+/** @brief Improves an order in place by bounded sifting.
+ *
+ *  Each variable, most frequent first, is moved by adjacent swaps up to
+ *  window positions in each direction and left where the clause-span cost
+ *  was lowest. A swap only changes the spans of clauses containing one of
+ *  the two variables, so each step costs the size of those clauses.
+ *
+ *  @param cnf     A pointer to a formula.
+ *  @param order   A permutation of 1..num_vars, updated in place.
+ *  @param window  The furthest a variable moves in one step.
+ *  @param passes  The most passes over all variables.
+ *  @return        The clause-span cost of the final order.
+ */
+long long ordering_sift(cnf_t *cnf, int *order, int window, int passes) {
+  const int n = cnf_get_num_vars(cnf);
+  csr_t occ = build_occurrences(cnf);
+  int *pos = xmalloc((n + 1) * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    pos[order[i]] = i;
+  }
+  int *stamp = xcalloc(cnf_get_num_clauses(cnf) + 1, sizeof(int));
+  int clock = 0;
+
+  // Visit variables by decreasing number of occurrences
+  int *by_occ = xmalloc((n + 1) * sizeof(int));
+  memcpy(by_occ, order, n * sizeof(int));
+  sort_graph = &occ;
+  qsort(by_occ, n, sizeof(int), by_degree);
+  for (int i = 0, j = n - 1; i < j; i++, j--) {
+    const int tmp = by_occ[i];
+    by_occ[i] = by_occ[j];
+    by_occ[j] = tmp;
+  }
+
+  for (int pass = 0; pass < passes; pass++) {
+    bool improved = false;
+    for (int k = 0; k < n; k++) {
+      const int v = by_occ[k];
+      if (degree(&occ, v) == 0) {
+        continue;
+      }
+
+      const int start = pos[v];
+      int best_pos = start;
+      long long cum = 0, best = 0;
+
+      // Move down, then back, then up
+      for (int s = 0; s < window && pos[v] < n - 1; s++) {
+        cum += sift_swap(cnf, &occ, order, pos, stamp, &clock, pos[v]);
+        if (cum < best) {
+          best = cum;
+          best_pos = pos[v];
+        }
+      }
+      while (pos[v] > start) {
+        cum += sift_swap(cnf, &occ, order, pos, stamp, &clock, pos[v] - 1);
+      }
+      for (int s = 0; s < window && pos[v] > 0; s++) {
+        cum += sift_swap(cnf, &occ, order, pos, stamp, &clock, pos[v] - 1);
+        if (cum < best) {
+          best = cum;
+          best_pos = pos[v];
+        }
+      }
+
+      // Settle at the best position seen
+      while (pos[v] < best_pos) {
+        sift_swap(cnf, &occ, order, pos, stamp, &clock, pos[v]);
+      }
+      improved |= (best < 0);
+    }
+
+    if (!improved) {
+      break;
+    }
+  }
+
+  long long cost = ordering_span_cost(cnf, order);
+  xfree(by_occ);
+  xfree(stamp);
+  xfree(pos);
+  free_csr(&occ);
+  return cost;
+}
+
+
+/** @brief Computes the elimination tree and induced width of an order.
+ *
+ *  Eliminating v connects its neighbors still in the graph. Rather than
+ *  add that fill, the later neighbors of v are merged from its original
+ *  neighbors and the later neighbors of its children in the tree, whose
+ *  lists are then freed. The parent of v is its first later neighbor.
+ *
+ *  @param cnf     A pointer to a formula.
+ *  @param order   A permutation of 1..num_vars, eliminated first to last.
+ *  @param parent  Filled with the parent of each variable, 0 for roots.
+ *                 Indexed by variable, so of size num_vars + 1. May be
+ *                 NULL when only the width is wanted.
+ *  @return        The induced width, the most later neighbors of any
+ *                 variable when it is eliminated.
+ */
+int ordering_elimination_tree(cnf_t *cnf, const int *order, int *parent) {
+  const int n = cnf_get_num_vars(cnf);
+  csr_t g = build_interactions(cnf);
+  int *tree = (parent != NULL) ? parent : xmalloc((n + 1) * sizeof(int));
+  int *pos = xmalloc((n + 1) * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    pos[order[i]] = i;
+  }
+
+  // Children lists, linked through next_child, and later-neighbor lists
+  int *first_child = xcalloc(n + 1, sizeof(int));
+  int *next_child = xcalloc(n + 1, sizeof(int));
+  int **later = xcalloc(n + 1, sizeof(int *));
+  int *num_later = xcalloc(n + 1, sizeof(int));
+  int *stamp = xcalloc(n + 1, sizeof(int));
+  int *buf = xmalloc((n + 1) * sizeof(int));
+
+  int width = 0;
+  for (int i = 0; i < n; i++) {
+    const int v = order[i];
+    int len = 0;
+    stamp[v] = v;
+    for (int a = g.start[v]; a < g.start[v + 1]; a++) {
+      const int u = g.adj[a];
+      if (pos[u] > i && stamp[u] != v) {
+        stamp[u] = v;
+        buf[len++] = u;
+      }
+    }
+    for (int c = first_child[v]; c != 0; c = next_child[c]) {
+      for (int k = 0; k < num_later[c]; k++) {
+        const int u = later[c][k];
+        if (stamp[u] != v) {
+          stamp[u] = v;
+          buf[len++] = u;
+        }
+      }
+      xfree(later[c]);
+      later[c] = NULL;
+    }
+
+    tree[v] = 0;
+    for (int k = 0; k < len; k++) {
+      if (tree[v] == 0 || pos[buf[k]] < pos[tree[v]]) {
+        tree[v] = buf[k];
+      }
+    }
+    if (tree[v] != 0) {
+      next_child[v] = first_child[tree[v]];
+      first_child[tree[v]] = v;
+      later[v] = xmalloc(len * sizeof(int));
+      memcpy(later[v], buf, len * sizeof(int));
+      num_later[v] = len;
+    }
+    if (len > width) {
+      width = len;
+    }
+  }
+
+  if (parent == NULL) {
+    xfree(tree);
+  }
+  xfree(first_child);
+  xfree(next_child);
+  xfree(later);
+  xfree(num_later);
+  xfree(stamp);
+  xfree(buf);
+  xfree(pos);
+  free_csr(&g);
+  return width;
+}
+
+
+/** @brief Assigns each clause to the bucket of its first eliminated variable.
+ *
+ *  @param cnf     A pointer to a formula.
+ *  @param order   A permutation of 1..num_vars, eliminated first to last.
+ *  @param bucket  Filled with the bucket variable of each clause, 0 for
+ *                 empty clauses. Of size cnf_get_num_clauses().
+ */
+void ordering_clause_buckets(cnf_t *cnf, const int *order, int *bucket) {
+  const int n = cnf_get_num_vars(cnf);
+  int *pos = xmalloc((n + 1) * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    pos[order[i]] = i;
+  }
+
+  const int num_clauses = cnf_get_num_clauses(cnf);
+  for (int c = 0; c < num_clauses; c++) {
+    int size;
+    const int *lits = cnf_get_clause(cnf, c, &size);
+    bucket[c] = 0;
+    for (int i = 0; i < size; i++) {
+      const int v = abs(lits[i]);
+      if (bucket[c] == 0 || pos[v] < pos[bucket[c]]) {
+        bucket[c] = v;
+      }
+    }
+  }
+
+  xfree(pos);
+}
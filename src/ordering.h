@@ -0,0 +1,54 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file ordering.h
+ *  @brief Heuristic BDD variable orders for a CNF formula.
+ *
+ *  See ordering.c for implementation details.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#ifndef _ORDERING_H_
+#define _ORDERING_H_
+
+#include "cnf.h"
+
+/** Ordering API
+ *
+ *  Orders are arrays of cnf_get_num_vars() variables, a permutation of
+ *  1..num_vars, first variable first. Returned orders must be freed.
+ */
+
+/** Construction */
+int *ordering_from_list(const int *vars, int size, int num_vars);
+int *ordering_rcm(cnf_t *cnf);
+int *ordering_min_fill(cnf_t *cnf);
+
+/** Improvement and cost */
+long long ordering_span_cost(cnf_t *cnf, const int *order);
+long long ordering_sift(cnf_t *cnf, int *order, int window, int passes);
+
+/** Elimination schedules */
+int ordering_elimination_tree(cnf_t *cnf, const int *order, int *parent);
+void ordering_clause_buckets(cnf_t *cnf, const int *order, int *bucket);
+
+#endif /* _ORDERING_H_ */
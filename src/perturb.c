@@ -0,0 +1,190 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file perturb.c
+ *  @brief Random edge flips around a base graph.
+ *
+ *  A perturbation flips random pairs of nodes between two partitions of a
+ *  base graph in place: a non-edge becomes an edge, and an edge is removed
+ *  unless one of its nodes would fall below a minimum degree. Each flip is
+ *  one bit test and one add or remove, so it takes O(1) time on the graph
+ *  bitsets and degree counters. The flips are recorded, and undone in
+ *  reverse, so many perturbed instances can be written from one base graph
+ *  without building it again.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "perturb.h"
+#include "rng.h"
+#include "xmalloc.h"
+
+// Random pairs tried per flip before giving up, when most are edges that
+//   cannot be removed
+#define MAX_TRIES 64
+
+/** @brief Defines a perturbation of a graph.
+ *
+ *  g:           The base graph, changed in place.
+ *  p1, p2:      The partitions whose edges are flipped.
+ *  min_degree:  Removals keep at least this many neighbors for each node.
+ *  r:           Random number generator, not reseeded between instances.
+ *  n1s, n2s:    The nodes of the flips applied, in order.
+ *  num_flips:   The number of flips applied.
+ *  cap:         The capacity of n1s and n2s.
+ */
+struct perturbation {
+  graph_t *g;
+  int p1;
+  int p2;
+  int min_degree;
+  rng_t r;
+  int *n1s;
+  int *n2s;
+  int num_flips;
+  int cap;
+};
+
+
+/** @brief Creates a perturbation of a graph.
+ *
+ *  @param g           A pointer to the base graph.
+ *  @param p1          The index of the first partition.
+ *  @param p2          The index of the second partition.
+ *  @param min_degree  The minimum degree kept by removals, at least 0.
+ *  @param seed        Random number seed.
+ *  @return            A pointer to a perturbation with no flips applied.
+ */
+perturb_t *perturb_create(graph_t *g, int p1, int p2, int min_degree, int seed) {
+  if (min_degree < 0) {
+    fprintf(stderr, "Minimum degree must be at least 0\n");
+    exit(-1);
+  }
+
+  perturb_t *p = xmalloc(sizeof(perturb_t));
+  p->g = g;
+  p->p1 = p1;
+  p->p2 = p2;
+  p->min_degree = min_degree;
+  rng_seed(&p->r, seed);
+  p->cap = 16;
+  p->n1s = xmalloc(p->cap * sizeof(int));
+  p->n2s = xmalloc(p->cap * sizeof(int));
+  p->num_flips = 0;
+  return p;
+}
+
+
+/** @brief Frees the memory of a perturbation, not its graph.
+ *
+ *  @param p  A pointer to a perturbation.
+ */
+void perturb_free(perturb_t *p) {
+  xfree(p->n1s);
+  xfree(p->n2s);
+  xfree(p);
+}
+
+
+/** @brief Returns the number of flips applied and not undone. */
+int perturb_get_num_flips(perturb_t *p) {
+  return p->num_flips;
+}
+
+
+/** @brief Flips an edge and records it.
+ *
+ *  @param p   A pointer to a perturbation.
+ *  @param n1  The node of partition p1.
+ *  @param n2  The node of partition p2.
+ */
+static void flip(perturb_t *p, int n1, int n2) {
+  if (graph_is_edge_between(p->g, p->p1, n1, p->p2, n2)) {
+    graph_remove_edge(p->g, p->p1, n1, p->p2, n2);
+  } else {
+    graph_add_edge(p->g, p->p1, n1, p->p2, n2);
+  }
+
+  if (p->num_flips == p->cap) {
+    p->cap *= 2;
+    p->n1s = xrealloc(p->n1s, p->cap * sizeof(int));
+    p->n2s = xrealloc(p->n2s, p->cap * sizeof(int));
+  }
+  p->n1s[p->num_flips] = n1;
+  p->n2s[p->num_flips++] = n2;
+}
+
+
+/** @brief Applies k random edge flips to the graph.
+ *
+ *  A pair is drawn uniformly at random. A non-edge is added; an edge is
+ *  removed if both of its nodes keep at least the minimum degree, and
+ *  otherwise another pair is drawn. A pair may be flipped more than once.
+ *
+ *  @param p  A pointer to a perturbation.
+ *  @param k  The number of flips.
+ *  @return   The number of flips applied, less than k only if a flip found
+ *            no pair to flip in MAX_TRIES draws.
+ */
+int perturb_apply(perturb_t *p, int k) {
+  const int *sizes = graph_get_partition_sizes(p->g);
+  const int size1 = sizes[p->p1], size2 = sizes[p->p2];
+  for (int f = 0; f < k; f++) {
+    int tries = 0;
+    while (true) {
+      if (tries++ == MAX_TRIES) {
+        return f;
+      }
+
+      const int n1 = rng_bounded(&p->r, size1);
+      const int n2 = rng_bounded(&p->r, size2);
+      if (graph_is_edge_between(p->g, p->p1, n1, p->p2, n2) &&
+          (graph_get_num_neighbors(p->g, p->p1, n1, p->p2) <= p->min_degree ||
+           graph_get_num_neighbors(p->g, p->p2, n2, p->p1) <= p->min_degree)) {
+        continue;
+      }
+      flip(p, n1, n2);
+      break;
+    }
+  }
+  return k;
+}
+
+
+/** @brief Undoes all applied flips, restoring the base graph.
+ *
+ *  @param p  A pointer to a perturbation.
+ */
+void perturb_undo(perturb_t *p) {
+  for (int f = p->num_flips - 1; f >= 0; f--) {
+    const int n1 = p->n1s[f], n2 = p->n2s[f];
+    if (graph_is_edge_between(p->g, p->p1, n1, p->p2, n2)) {
+      graph_remove_edge(p->g, p->p1, n1, p->p2, n2);
+    } else {
+      graph_add_edge(p->g, p->p1, n1, p->p2, n2);
+    }
+  }
+  p->num_flips = 0;
+}
@@ -0,0 +1,55 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file perturb.h
+ *  @brief Random edge flips around a base graph.
+ *
+ *  See perturb.c for documentation and implementation details.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#ifndef _PERTURB_H_
+#define _PERTURB_H_
+
+#include "graph.h"
+
+/** @brief Defines a perturbation of a graph.
+ *
+ *  See perturb.c for struct fields and motivation.
+ */
+typedef struct perturbation perturb_t;
+
+
+/** Perturbation API */
+
+/** Creation and free functions */
+perturb_t *perturb_create(graph_t *g, int p1, int p2, int min_degree, int seed);
+void perturb_free(perturb_t *p);
+
+/** Getters */
+int perturb_get_num_flips(perturb_t *p);
+
+/** Modification functions */
+int perturb_apply(perturb_t *p, int k);
+void perturb_undo(perturb_t *p);
+
+#endif /* _PERTURB_H_ */
@@ -33,7 +33,9 @@
  *  A pigeonhole problem is defined by an integer n, where n is the number
  *  of holes and (n + 1) is the number of pigeons.
  *
- *  TODO variants? Bookkeeping information?
+ *  The functional and onto variants only add constraints (see bipartgen),
+ *  so they share the graph. The relativized variant routes the pigeons
+ *  through resting places, see pigeon_generate_relativized_graph().
  */
 struct pigeonhole_problem {
   int n;
@@ -86,3 +88,25 @@ graph_t *pigeon_generate_graph(pigeon_t *p) {
 
   return g;
 }
+
+
+/** @brief Generates the tripartite graph of a relativized pigeonhole problem.
+ *
+ *  Pigeons (partition 0) fly to resting places (partition 1), and each
+ *  occupied resting place is mapped to a hole (partition 2), at most one
+ *  resting place per hole. Every pigeon may use every resting place, and
+ *  every resting place every hole.
+ *
+ *  @param p        A pointer to a pigeonhole problem.
+ *  @param resting  The number of resting places.
+ *  @return         A pointer to a graph structure with three partitions.
+ */
+graph_t *pigeon_generate_relativized_graph(pigeon_t *p, int resting) {
+  int sizes[3] = { p->n + 1, resting, p->n };
+  graph_t *g = graph_create_with_sizes(3, sizes);
+
+  graph_fully_connect_partition(g, 0, 1);
+  graph_fully_connect_partition(g, 1, 2);
+
+  return g;
+}
@@ -48,5 +48,6 @@ int pigeon_get_n(pigeon_t *p);
 
 /** Generators */
 graph_t *pigeon_generate_graph(pigeon_t *p);
+graph_t *pigeon_generate_relativized_graph(pigeon_t *p, int resting);
 
 #endif /* _PIGEON_H_ */
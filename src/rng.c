@@ -0,0 +1,140 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file rng.c
+ *  @brief A small, seedable pseudo-random number generator.
+ *
+ *  The generator is xoshiro256** (Blackman and Vigna), seeded by running
+ *  splitmix64 over the user-provided seed. Bounded integers are drawn with
+ *  Lemire's nearly-divisionless method, which avoids the modulo bias of
+ *  rand() % n and only divides on the rare rejection path.
+ *
+ *  Unlike rand(), the state is local to an rng_t, so independent streams
+ *  (e.g. one for graph generation, one for output scrambling) do not
+ *  perturb one another.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include "rng.h"
+
+/** @brief Rotates a 64-bit word left by k bits. */
+#define ROTL(x, k)  (((x) << (k)) | ((x) >> (64 - (k))))
+
+
+/** @brief One step of splitmix64, used only to expand the seed.
+ *
+ *  @param x  A pointer to the splitmix64 state, updated in place.
+ *  @return   The next splitmix64 output.
+ */
+static uint64_t splitmix64(uint64_t *x) {
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+
+/** @brief Seeds a generator.
+ *
+ *  The same seed always produces the same stream of numbers.
+ *
+ *  @param r     A pointer to the generator.
+ *  @param seed  The seed.
+ */
+void rng_seed(rng_t *r, uint64_t seed) {
+  uint64_t x = seed;
+  for (int i = 0; i < 4; i++) {
+    r->s[i] = splitmix64(&x);
+  }
+}
+
+
+/** @brief Returns the next 64 random bits.
+ *
+ *  @param r  A pointer to the generator.
+ *  @return   A uniformly distributed 64-bit value.
+ */
+uint64_t rng_next(rng_t *r) {
+  uint64_t *s = r->s;
+  const uint64_t result = ROTL(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = ROTL(s[3], 45);
+
+  return result;
+}
+
+
+/** @brief Returns a uniformly distributed integer in [0, range).
+ *
+ *  Lemire's method: the high half of a 32x32 bit multiply is the result,
+ *  and the low half is only compared against the rejection threshold when
+ *  it could be biased, so the division is almost never taken.
+ *
+ *  @param r      A pointer to the generator.
+ *  @param range  The exclusive upper bound. Must be at least 1.
+ *  @return       An unbiased integer in [0, range).
+ */
+uint32_t rng_bounded(rng_t *r, uint32_t range) {
+  uint64_t m = (rng_next(r) >> 32) * (uint64_t) range;
+  uint32_t low = (uint32_t) m;
+  if (low < range) {
+    const uint32_t threshold = -range % range;
+    while (low < threshold) {
+      m = (rng_next(r) >> 32) * (uint64_t) range;
+      low = (uint32_t) m;
+    }
+  }
+
+  return (uint32_t) (m >> 32);
+}
+
+
+/** @brief Returns a uniformly distributed double in [0, 1).
+ *
+ *  @param r  A pointer to the generator.
+ *  @return   A double with 53 random bits of mantissa.
+ */
+double rng_double(rng_t *r) {
+  return (rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+/** @brief Shuffles an array of integers uniformly (Fisher-Yates).
+ *
+ *  @param r     A pointer to the generator.
+ *  @param arr   The array to shuffle in place.
+ *  @param size  The number of elements in the array.
+ */
+void rng_shuffle(rng_t *r, int *arr, int size) {
+  for (int i = size - 1; i > 0; i--) {
+    int j = rng_bounded(r, i + 1);
+    int temp = arr[i];
+    arr[i] = arr[j];
+    arr[j] = temp;
+  }
+}
@@ -0,0 +1,221 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file writer.c
+ *  @brief Buffered writer for integer-heavy text output (CNFs, order files).
+ *
+ *  Formulas are written one literal at a time, and calling fprintf() per
+ *  literal spends most of its time parsing the format string. The writer
+ *  instead formats integers by hand into a fixed buffer and hands full
+ *  buffers to fwrite().
+ *
+ *  The writer does not own the FILE; writer_free() flushes but does not
+ *  close it.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <string.h>
+
+#include "writer.h"
+#include "xmalloc.h"
+
+/** @brief Size of the output buffer, in bytes. */
+#define WRITER_BUF_SIZE   (1 << 16)
+
+/** @brief Longest formatted integer, including sign. */
+#define MAX_INT_CHARS     21
+
+
+/** @brief Defines a buffered writer.
+ *
+ *  f:        The file being written to.
+ *  buf:      The output buffer.
+ *  len:      Number of bytes currently in buf.
+ *  flushed:  Number of bytes handed to the file so far.
+ */
+struct buffered_writer {
+  FILE *f;
+  char *buf;
+  int len;
+  long long flushed;
+}; // writer_t
+
+
+/** @brief Creates a buffered writer on an open file.
+ *
+ *  @param f  An open file.
+ *  @return   A pointer to a writer.
+ */
+writer_t *writer_create(FILE *f) {
+  writer_t *w = xmalloc(sizeof(writer_t));
+  w->f = f;
+  w->buf = xmalloc(WRITER_BUF_SIZE);
+  w->len = 0;
+  w->flushed = 0;
+  return w;
+}
+
+
+/** @brief Flushes and frees a writer. The file is left open.
+ *
+ *  @param w  A pointer to a writer.
+ */
+void writer_free(writer_t *w) {
+  writer_flush(w);
+  xfree(w->buf);
+  xfree(w);
+}
+
+
+/** @brief Hands the buffered bytes to the underlying file.
+ *
+ *  @param w  A pointer to a writer.
+ */
+void writer_flush(writer_t *w) {
+  if (w->len > 0) {
+    fwrite(w->buf, 1, w->len, w->f);
+    w->flushed += w->len;
+    w->len = 0;
+  }
+}
+
+
+/** @brief Flushes a writer and points it at another file.
+ *
+ *  The buffer is kept, so one writer can write many files in turn.
+ *  Offsets count from the start of the new file.
+ *
+ *  @param w  A pointer to a writer.
+ *  @param f  An open file.
+ */
+void writer_set_file(writer_t *w, FILE *f) {
+  writer_flush(w);
+  w->f = f;
+  w->flushed = 0;
+}
+
+
+/** @brief Returns the number of bytes written through the writer.
+ *
+ *  Counts buffered bytes as well, so this is the offset in the file that
+ *  the next byte will land at (if the file was empty when the writer was
+ *  created).
+ *
+ *  @param w  A pointer to a writer.
+ *  @return   The number of bytes written so far.
+ */
+long long writer_get_offset(writer_t *w) {
+  return w->flushed + w->len;
+}
+
+
+/** @brief Ensures that at least n bytes are free in the buffer. */
+static inline void reserve(writer_t *w, int n) {
+  if (w->len + n > WRITER_BUF_SIZE) {
+    writer_flush(w);
+  }
+}
+
+
+/** @brief Formats an integer into the buffer without a separator. */
+static inline void put_int(writer_t *w, long long x) {
+  char tmp[MAX_INT_CHARS];
+  int t = 0;
+  unsigned long long u;
+  if (x < 0) {
+    w->buf[w->len++] = '-';
+    u = -(unsigned long long) x;
+  } else {
+    u = x;
+  }
+
+  do {
+    tmp[t++] = '0' + (u % 10);
+    u /= 10;
+  } while (u > 0);
+
+  while (t > 0) {
+    w->buf[w->len++] = tmp[--t];
+  }
+}
+
+
+/** @brief Writes an integer in decimal, with no trailing separator.
+ *
+ *  @param w  A pointer to a writer.
+ *  @param x  The integer to write.
+ */
+void writer_write_int(writer_t *w, long long x) {
+  reserve(w, MAX_INT_CHARS);
+  put_int(w, x);
+}
+
+
+/** @brief Writes a single character.
+ *
+ *  @param w  A pointer to a writer.
+ *  @param c  The character to write.
+ */
+void writer_write_char(writer_t *w, char c) {
+  reserve(w, 1);
+  w->buf[w->len++] = c;
+}
+
+
+/** @brief Writes a NUL-terminated string.
+ *
+ *  @param w  A pointer to a writer.
+ *  @param s  The string to write.
+ */
+void writer_write_str(writer_t *w, const char *s) {
+  int n = strlen(s);
+  if (n > WRITER_BUF_SIZE) {
+    writer_flush(w);
+    fwrite(s, 1, n, w->f);
+    w->flushed += n;
+    return;
+  }
+
+  reserve(w, n);
+  memcpy(w->buf + w->len, s, n);
+  w->len += n;
+}
+
+
+/** @brief Writes a clause as a DIMACS line: "l1 l2 ... 0\n".
+ *
+ *  @param w     A pointer to a writer.
+ *  @param lits  The literals of the clause.
+ *  @param size  The number of literals.
+ */
+void writer_write_clause(writer_t *w, const int *lits, int size) {
+  for (int i = 0; i < size; i++) {
+    reserve(w, MAX_INT_CHARS + 1);
+    put_int(w, lits[i]);
+    w->buf[w->len++] = ' ';
+  }
+
+  reserve(w, 2);
+  w->buf[w->len++] = '0';
+  w->buf[w->len++] = '\n';
+}
+
@@ -0,0 +1,59 @@
+/**********************************************************************************
+ Copyright (c) 2021 Joseph Reeves and Cayden Codel, Carnegie Mellon University
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ associated documentation files (the "Software"), to deal in the Software without restriction,
+ including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ **************************************************************************************************/
+
+
+/** @file writer.h
+ *  @brief Buffered writer for integer-heavy text output (CNFs, order files).
+ *
+ *  See writer.c for implementation details.
+ *
+ *  @author Joseph Reeves (jereeves@andrew.cmu.edu)
+ *  @author Cayden Codel  (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#ifndef _WRITER_H_
+#define _WRITER_H_
+
+#include <stdio.h>
+
+/** @brief Defines a buffered writer.
+ *
+ *  See writer.c for struct fields and motivation.
+ */
+typedef struct buffered_writer writer_t;
+
+
+/** Writer API */
+
+/** Creation and free functions */
+writer_t *writer_create(FILE *f);
+void writer_free(writer_t *w);
+
+/** Output functions */
+void writer_write_int(writer_t *w, long long x);
+void writer_write_char(writer_t *w, char c);
+void writer_write_str(writer_t *w, const char *s);
+void writer_write_clause(writer_t *w, const int *lits, int size);
+void writer_flush(writer_t *w);
+void writer_set_file(writer_t *w, FILE *f);
+
+/** Getters */
+long long writer_get_offset(writer_t *w);
+
+#endif /* _WRITER_H_ */
@@ -0,0 +1,101 @@
+/** @file additionalgraphs_test.c
+ *  @brief Tests the random graph generators of additionalgraphs.c.
+ *
+ *  @author Cayden Codel (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "additionalgraphs.h"
+#include "graph.h"
+
+#define N 6
+#define SEEDS 8
+
+/** @brief Checks that two graphs on the same partitions have the same edges,
+ *         and returns the number of edges.
+ */
+static int check_same_edges(graph_t *g, graph_t *h) {
+  const int *sizes = graph_get_partition_sizes(g);
+  int edges = 0;
+  for (int i = 0; i < sizes[0]; i++) {
+    for (int j = 0; j < sizes[1]; j++) {
+      assert(graph_is_edge_between(g, 0, i, 1, j) ==
+             graph_is_edge_between(h, 0, i, 1, j));
+      edges += graph_is_edge_between(g, 0, i, 1, j);
+    }
+  }
+  return edges;
+}
+
+/** @brief Checks that graphs reused across a range of seeds, as with -R,
+ *         match those generated for each seed on its own.
+ */
+static void check_seed_range(int cardinality, float density, int nedges,
+    int expected_edges) {
+  graph_var_t *shared = graph_var_create(N, cardinality, density, nedges);
+  graph_t *g = generate_random_graph(shared, 0);
+  for (int seed = 1; seed <= SEEDS; seed++) {
+    generate_random_graph_into(shared, seed, g);
+
+    graph_var_t *single = graph_var_create(N, cardinality, density, nedges);
+    graph_t *h = generate_random_graph(single, seed);
+    const int edges = check_same_edges(g, h);
+    if (expected_edges > 0) {
+      assert(edges == expected_edges);
+    }
+    graph_free(h);
+    graph_var_free(single);
+  }
+  graph_free(g);
+  graph_var_free(shared);
+}
+
+/** @brief Checks the structured generators with a negative cardinality,
+ *         where partition 0 is the smaller side.
+ */
+static void check_negative_cardinality(void) {
+  graph_var_t *gv = graph_var_create(N, -2, 1.0, 1);
+  for (int seed = 1; seed <= SEEDS; seed++) {
+    // The planted matching covers the smaller side, and nothing else is
+    //   drawn when at most that many edges are asked for
+    graph_t *g = generate_planted_graph(gv, seed);
+    int right_degrees[N] = { 0 };
+    for (int i = 0; i < N - 2; i++) {
+      assert(graph_get_num_neighbors(g, 0, i, 1) == 1);
+      for (int j = 0; j < N; j++) {
+        right_degrees[j] += graph_is_edge_between(g, 0, i, 1, j);
+      }
+    }
+    for (int j = 0; j < N; j++) {
+      assert(right_degrees[j] <= 1);
+    }
+    graph_free(g);
+
+    graph_t *h = generate_power_law_graph(gv, seed);
+    assert(graph_get_partition_sizes(h)[0] == N - 2);
+    graph_free(h);
+  }
+  graph_var_free(gv);
+}
+
+int main() {
+  // Edge counts below the number of pairs are met exactly
+  check_seed_range(1, 1.0, 15, 15);
+  check_seed_range(0, 1.0, 20, 20);
+
+  // Drawing every pair, or asking for more, gives the complete graph and
+  //   leaves the pool as it was for the next seed
+  check_seed_range(1, 1.0, (N + 1) * N, (N + 1) * N);
+  check_seed_range(0, 1.0, N * N + 5, N * N);
+
+  // Density draws each edge independently
+  check_seed_range(1, 0.4, 0, 0);
+
+  check_negative_cardinality();
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+/** @file automorphism_test.c
+ *  @brief Tests the automorphism.c file.
+ *
+ *  @author Cayden Codel (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#include "automorphism.h"
+#include "mchess.h"
+#include "pigeon.h"
+#include "graph.h"
+
+/** @brief Checks that every generator maps the edges of g onto edges. */
+static void check_generators(graph_t *g, automorphism_t *a) {
+  const int *sizes = graph_get_partition_sizes(g);
+  for (int gen = 0; gen < automorphism_get_num_generators(a); gen++) {
+    for (int n1 = 0; n1 < sizes[0]; n1++) {
+      const int m1 = automorphism_get_image(a, gen, 0, n1);
+      assert(m1 >= 0 && m1 < sizes[0]);
+      for (int n2 = 0; n2 < sizes[1]; n2++) {
+        const int m2 = automorphism_get_image(a, gen, 1, n2);
+        assert(graph_is_edge_between(g, 0, n1, 1, n2) ==
+               graph_is_edge_between(g, 0, m1, 1, m2));
+      }
+    }
+  }
+}
+
+static void check_order(automorphism_t *a, double order) {
+  assert(automorphism_is_complete(a));
+  assert(fabs(automorphism_get_log_order(a) - log10(order)) < 1e-9);
+}
+
+int main() {
+  // Pigeons and holes are each permuted freely: 4! * 3!
+  pigeon_t *pigeon = pigeon_create(3);
+  graph_t *g = pigeon_generate_graph(pigeon);
+  automorphism_t *a = automorphism_find(g, 1000000);
+  check_generators(g, a);
+  check_order(a, 24 * 6);
+  automorphism_free(a);
+  graph_free(g);
+  pigeon_free(pigeon);
+
+  // Rotations of a 6-cycle by two nodes, and the reflections through a
+  //   node, keep the partitions
+  g = graph_create(2, 3);
+  for (int i = 0; i < 3; i++) {
+    graph_add_edge(g, 0, i, 1, i);
+    graph_add_edge(g, 0, i, 1, (i + 1) % 3);
+  }
+  a = automorphism_find(g, 1000000);
+  check_generators(g, a);
+  check_order(a, 6);
+  automorphism_free(a);
+
+  // Reversing a path of four nodes swaps the partitions, so only the
+  //   identity is left
+  graph_t *path = graph_create(2, 2);
+  graph_add_edge(path, 0, 0, 1, 0);
+  graph_add_edge(path, 0, 1, 1, 0);
+  graph_add_edge(path, 0, 1, 1, 1);
+  a = automorphism_find(path, 1000000);
+  assert(automorphism_get_num_generators(a) == 0);
+  check_order(a, 1);
+  automorphism_free(a);
+
+  // The mutilated chessboard keeps the symmetries of the square that map
+  //   the removed corners onto each other: two reflections and a rotation
+  mchess_t *mc = mchess_create(8, NORMAL);
+  graph_t *board = mchess_generate_graph(mc);
+  a = automorphism_find(board, 1000000);
+  check_generators(board, a);
+  check_order(a, 4);
+  automorphism_free(a);
+
+  // A search limit keeps the generators found so far
+  a = automorphism_find(board, 1);
+  assert(!automorphism_is_complete(a));
+  check_generators(board, a);
+  automorphism_free(a);
+
+  return 0;
+}
@@ -0,0 +1,179 @@
+/** @file cnf_test.c
+ *  @brief Tests the cnf.c file.
+ *
+ *  @author Cayden Codel (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#define _DEFAULT_SOURCE // For mkstemp(), fork()
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "cnf.h"
+#include "dimacs.h"
+#include "rng.h"
+
+#define V 50
+#define C 200
+
+int main() {
+  cnf_t *cnf = cnf_create(V);
+  rng_t r;
+  rng_seed(&r, 1);
+
+  // Add clauses of the form (i, -(i + 1), i + 2)
+  for (int i = 0; i < C; i++) {
+    int v = (i % (V - 2)) + 1;
+    cnf_add_lit(cnf, v);
+    cnf_add_lit(cnf, -(v + 1));
+    cnf_add_lit(cnf, v + 2);
+    cnf_add_lit(cnf, 0);
+  }
+  assert(cnf_get_num_clauses(cnf) == C);
+  assert(cnf_get_num_vars(cnf) == V);
+
+  // Variable maps must be signed bijections on [1, V]
+  int *var_map = cnf_random_var_map(V, &r, true, 0.5);
+  int seen[V + 1] = { 0 };
+  assert(var_map[0] == 0);
+  for (int v = 1; v <= V; v++) {
+    int w = abs(var_map[v]);
+    assert(1 <= w && w <= V);
+    assert(seen[w] == 0);
+    seen[w] = 1;
+  }
+
+  // Mapping keeps clause sizes and maps literals consistently
+  cnf_apply_var_map(cnf, var_map);
+  for (int i = 0; i < C; i++) {
+    int size;
+    const int *lits = cnf_get_clause(cnf, i, &size);
+    int v = (i % (V - 2)) + 1;
+    assert(size == 3);
+    assert(lits[0] == var_map[v]);
+    assert(lits[1] == -var_map[v + 1]);
+    assert(lits[2] == var_map[v + 2]);
+  }
+
+  // Shuffling clauses and literals keeps the multiset of literals
+  long long sum_before = 0, sum_after = 0;
+  for (int i = 0; i < C; i++) {
+    int size;
+    const int *lits = cnf_get_clause(cnf, i, &size);
+    for (int j = 0; j < size; j++) {
+      sum_before += lits[j] * (long long) lits[j] * lits[j];
+    }
+  }
+
+  cnf_shuffle_lits(cnf, &r, 1.0);
+  cnf_shuffle_clauses(cnf, &r);
+  assert(cnf_get_num_clauses(cnf) == C);
+  for (int i = 0; i < C; i++) {
+    int size;
+    const int *lits = cnf_get_clause(cnf, i, &size);
+    assert(size == 3);
+    for (int j = 0; j < size; j++) {
+      sum_after += lits[j] * (long long) lits[j] * lits[j];
+    }
+  }
+  assert(sum_before == sum_after);
+
+  // Bounded draws stay in range
+  for (int i = 0; i < 10000; i++) {
+    assert(rng_bounded(&r, 7) < 7);
+  }
+
+  // Sections record the byte ranges of their clauses when written
+  cnf_t *sec = cnf_create(3);
+  int a[] = { 1, -2 }, b[] = { 3 };
+  cnf_begin_section(sec, "first");
+  cnf_add_clause(sec, a, 2);
+  cnf_begin_section(sec, "second");
+  cnf_add_comment(sec, "marker");
+  cnf_add_clause(sec, b, 1);
+  cnf_add_clause(sec, b, 1);
+  FILE *tmp = tmpfile();
+  cnf_write_dimacs(sec, tmp);
+  rewind(tmp);
+  cnf_write_sections(sec, tmp);
+  fflush(tmp);
+  rewind(tmp);
+  char line[128];
+  assert(fgets(line, sizeof(line), tmp) != NULL && line[0] == 'c');
+  assert(fgets(line, sizeof(line), tmp) != NULL);
+  assert(strcmp(line, "0 1 10 7 first\n") == 0);
+  assert(fgets(line, sizeof(line), tmp) != NULL);
+  assert(strcmp(line, "1 2 26 8 second\n") == 0);
+  fclose(tmp);
+  cnf_free(sec);
+
+  // Writing and reading back through dimacs_open() keeps every clause
+  char path[] = "/tmp/cnf_testXXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  tmp = fdopen(fd, "w");
+  cnf_add_comment(cnf, "round trip");
+  cnf_write_dimacs(cnf, tmp);
+  fclose(tmp);
+  dimacs_reader_t *reader = dimacs_open(path);
+  assert(dimacs_get_num_vars(reader) == V);
+  assert(dimacs_get_num_clauses(reader) == C);
+  for (int pass = 0; pass < 2; pass++) {
+    int read = 0;
+    bool commented = false;
+    dimacs_item_t item;
+    while ((item = dimacs_next(reader)) != DIMACS_EOF) {
+      if (item == DIMACS_COMMENT) {
+        commented |= strcmp(dimacs_get_comment(reader), "round trip") == 0;
+        continue;
+      }
+      int read_size, size;
+      const int *read_lits = dimacs_get_clause(reader, &read_size);
+      const int *lits = cnf_get_clause(cnf, read, &size);
+      assert(read_size == size);
+      assert(memcmp(read_lits, lits, size * sizeof(int)) == 0);
+      read++;
+    }
+    assert(read == C && commented);
+    dimacs_rewind(reader);
+  }
+  dimacs_close(reader);
+
+  // A literal beyond the header's variable count is a parse error
+  tmp = fopen(path, "w");
+  fputs("p cnf 2 1\n1 5 0\n", tmp);
+  fclose(tmp);
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    FILE *null = freopen("/dev/null", "w", stderr);
+    assert(null != NULL);
+    reader = dimacs_open(path);
+    while (dimacs_next(reader) != DIMACS_EOF);
+    exit(0);
+  }
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) != 0);
+  remove(path);
+
+  // A cleared formula can be refilled
+  cnf_add_comment(cnf, "section");
+  cnf_clear(cnf);
+  assert(cnf_get_num_clauses(cnf) == 0);
+  int unit = 1;
+  cnf_add_clause(cnf, &unit, 1);
+  int size;
+  const int *lits = cnf_get_clause(cnf, 0, &size);
+  assert(cnf_get_num_clauses(cnf) == 1 && size == 1 && lits[0] == 1);
+
+  free(var_map);
+  cnf_free(cnf);
+  return 0;
+}
@@ -0,0 +1,68 @@
+/** @file coloring_test.c
+ *  @brief Tests the coloring.c file.
+ *
+ *  @author Cayden Codel (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "coloring.h"
+#include "graph.h"
+
+#define V 12
+
+int main() {
+  // A complete graph is one clique
+  coloring_t *k = coloring_create(V, 3, 1.0, 0, 1);
+  int size;
+  assert(coloring_get_num_cliques(k) == 1);
+  coloring_get_clique(k, 0, &size);
+  assert(size == V);
+
+  // Cliques of a sparse graph are cliques, and cover every edge
+  coloring_t *c = coloring_create(V, 3, 0.0, 25, 7);
+  int edges = 0;
+  for (int u = 0; u < V; u++) {
+    for (int v = u + 1; v < V; v++) {
+      edges += coloring_is_edge(c, u, v);
+    }
+  }
+  assert(edges == 25);
+  for (int u = 0; u < V; u++) {
+    for (int v = u + 1; v < V; v++) {
+      if (!coloring_is_edge(c, u, v)) continue;
+      int covered = 0;
+      for (int i = 0; i < coloring_get_num_cliques(c) && !covered; i++) {
+        const int *clique = coloring_get_clique(c, i, &size);
+        int found = 0;
+        for (int j = 0; j < size; j++) {
+          found += (clique[j] == u || clique[j] == v);
+        }
+        covered = (found == 2);
+      }
+      assert(covered);
+    }
+  }
+  for (int i = 0; i < coloring_get_num_cliques(c); i++) {
+    const int *clique = coloring_get_clique(c, i, &size);
+    for (int j = 0; j < size; j++) {
+      for (int l = j + 1; l < size; l++) {
+        assert(clique[j] < clique[l] && coloring_is_edge(c, clique[j], clique[l]));
+      }
+    }
+  }
+
+  // Every vertex may take every color
+  graph_t *g = coloring_generate_graph(c);
+  const int *sizes = graph_get_partition_sizes(g);
+  assert(sizes[0] == V && sizes[1] == 3);
+  assert(graph_get_num_neighbors(g, 0, 5, 1) == 3);
+
+  graph_free(g);
+  coloring_free(c);
+  coloring_free(k);
+  return 0;
+}
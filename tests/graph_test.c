@@ -11,7 +11,7 @@
 #include <stdlib.h>
 #include <assert.h>
 
-#include "../graph.h" // TODO think about making an inc/ and src/ directories
+#include "graph.h" // TODO think about making an inc/ and src/ directories
 
 #define K 2
 #define N 5
@@ -52,5 +52,84 @@ int main() {
     assert(graph_get_edge_id(g, 0, i, 1, i) == (i + N));
   }
 
+  // Neighbor iterators agree with graph_is_edge_between across words
+  graph_t *h = graph_create(K, 150);
+  for (int i = 0; i < 150; i += 7) {
+    graph_add_edge(h, 0, 3, 1, i);
+  }
+  int expected = 0;
+  for (int n = graph_get_next_neighbor(h, 0, 3, 1, 0); n >= 0;
+      n = graph_get_next_neighbor(h, 0, 3, 1, n + 1)) {
+    assert(n == expected);
+    expected += 7;
+  }
+  assert(expected >= 150);
+
+  int non_neighbors = 0;
+  for (int n = graph_get_next_non_neighbor(h, 0, 3, 1, 0); n >= 0;
+      n = graph_get_next_non_neighbor(h, 0, 3, 1, n + 1)) {
+    assert(n < 150 && !graph_is_edge_between(h, 0, 3, 1, n));
+    non_neighbors++;
+  }
+  assert(non_neighbors == 150 - graph_get_num_neighbors(h, 0, 3, 1));
+  assert(graph_get_next_neighbor(h, 0, 4, 1, 0) == -1);
+
+  // Batches of edges skip repeats and edges already present
+  int lefts[] = { 3, 3, 4, 4 }, rights[] = { 0, 1, 1, 1 };
+  graph_add_edges(h, 0, 1, lefts, rights, 4);
+  assert(graph_is_edge_between(h, 0, 3, 1, 1) && graph_is_edge_between(h, 1, 1, 0, 4));
+  assert(graph_get_num_neighbors(h, 0, 3, 1) == 23);
+  assert(graph_get_num_neighbors(h, 0, 4, 1) == 1);
+  assert(graph_get_num_neighbors(h, 1, 1, 0) == 2);
+
+  // Node 0 joins g into one component; h has a star around node 3,
+  //   joined by node 4, and isolated nodes
+  assert(graph_count_components(g) == 1);
+  assert(graph_count_components(h) == 1 + (150 - 2) + (150 - 23));
+
+  // Clearing leaves no edges, and the graph can be refilled
+  graph_clear(h);
+  assert(graph_get_next_neighbor(h, 0, 3, 1, 0) == -1);
+  assert(graph_get_num_neighbors(h, 1, 1, 0) == 0);
+  assert(graph_count_components(h) == 300);
+  graph_add_edge(h, 0, 3, 1, 1);
+  assert(graph_get_num_neighbors(h, 0, 3, 1) == 1);
+
+  // K_{3,3} has two edge-disjoint perfect matchings on each of the 6 pairs
+  //   of nodes rooted at node 0, and three on all nodes
+  graph_t *k33 = graph_create(K, 3);
+  graph_fully_connect_partition(k33, 0, 1);
+  graph_generate_perfect_matchings(k33, 3);
+  assert(graph_get_num_matchings(k33, 0, 0, 1) == 6 * 2 + 3);
+  assert(graph_get_num_matchings(k33, 0, 2, 1) == 0);
+  int sets = 0;
+  for (matching_t *m = graph_get_first_matching(k33, 0, 0, 1); m != NULL;
+      m = graph_get_next_set(m)) {
+    const int size = graph_get_matching_size(m);
+    assert(graph_get_num_similar_matchings(m) == size);
+    assert(graph_get_matching_left_nodes(m)[0] == 0);
+    sets++;
+  }
+  assert(sets == 7);
+
+  // A 6-cycle has two perfect matchings, on all of its nodes
+  graph_t *c6 = graph_create(K, 3);
+  for (int i = 0; i < 3; i++) {
+    graph_add_edge(c6, 0, i, 1, i);
+    graph_add_edge(c6, 0, i, 1, (i + 1) % 3);
+  }
+  graph_generate_perfect_matchings(c6, 3);
+  assert(graph_get_num_matchings(c6, 0, 0, 1) == 2);
+  matching_t *m = graph_get_first_matching(c6, 0, 0, 1);
+  assert(graph_get_matching_size(m) == 3 && graph_get_next_set(m) == NULL);
+  const int *first = graph_get_matching_ordered_right_nodes(m);
+  m = graph_get_next_matching(m);
+  const int *second = graph_get_matching_ordered_right_nodes(m);
+  for (int i = 0; i < 3; i++) {
+    assert(first[i] != second[i]);
+    assert(graph_is_edge_between(c6, 0, i, 1, first[i]));
+    assert(graph_is_edge_between(c6, 0, i, 1, second[i]));
+  }
+
   return 0;
 }
@@ -0,0 +1,80 @@
+/** @file grid_test.c
+ *  @brief Tests the grid.c file.
+ *
+ *  @author Cayden Codel (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "grid.h"
+#include "mchess.h"
+#include "graph.h"
+
+#define N 8
+
+int main() {
+  // A square grid with its corners removed is the mutilated chessboard
+  int square[2] = { N, N };
+  grid_t *grid = grid_create(2, square);
+  grid_remove_corners(grid);
+  graph_t *g = grid_generate_graph(grid);
+
+  mchess_t *mc = mchess_create(N, NORMAL);
+  graph_t *h = mchess_generate_graph(mc);
+  const int *sizes = graph_get_partition_sizes(g);
+  const int *mc_sizes = graph_get_partition_sizes(h);
+  assert(sizes[0] == mc_sizes[0] && sizes[1] == mc_sizes[1]);
+  for (int i = 0; i < sizes[0]; i++) {
+    for (int j = 0; j < sizes[1]; j++) {
+      assert(graph_is_edge_between(g, 0, i, 1, j) ==
+          graph_is_edge_between(h, 0, i, 1, j));
+    }
+  }
+
+  // Ids count up by color in row-major order
+  int cell[2] = { 0, 0 };
+  assert(grid_get_tile_id(grid, cell) == -1);
+  cell[1] = 1;
+  assert(grid_get_tile_id(grid, cell) == 0 && !grid_is_white(grid, cell));
+  cell[1] = 2;
+  assert(grid_get_tile_id(grid, cell) == 0 && grid_is_white(grid, cell));
+
+  // A full 3 x 4 x 5 box has 2 * 4 * 5 + 3 * 3 * 5 + 3 * 4 * 4 edges
+  int box[3] = { 3, 4, 5 };
+  grid_t *cube = grid_create(3, box);
+  graph_t *c = grid_generate_graph(cube);
+  sizes = graph_get_partition_sizes(c);
+  assert(sizes[0] == 30 && sizes[1] == 30);
+  int edges = 0;
+  for (int i = 0; i < sizes[0]; i++) {
+    edges += graph_get_num_neighbors(c, 0, i, 1);
+  }
+  assert(edges == 40 + 45 + 48);
+
+  // Removing a black cell drops its 6 edges, and the opposite corner
+  //   (2, 3, 4) is black, so (2, 3, 3) is removed with its 4 edges
+  int center[3] = { 1, 1, 1 };
+  assert(!grid_is_white(cube, center));
+  grid_remove_cell(cube, center);
+  grid_remove_corners(cube);
+  graph_t *m = grid_generate_graph(cube);
+  sizes = graph_get_partition_sizes(m);
+  assert(sizes[0] == 30 - 2 && sizes[1] == 30 - 1);
+  int mutilated = 0;
+  for (int i = 0; i < sizes[0]; i++) {
+    mutilated += graph_get_num_neighbors(m, 0, i, 1);
+  }
+  assert(mutilated == edges - 6 - 3 - 4);
+
+  graph_free(g);
+  graph_free(h);
+  graph_free(c);
+  graph_free(m);
+  grid_free(grid);
+  grid_free(cube);
+  mchess_free(mc);
+  return 0;
+}
@@ -110,5 +110,39 @@ int main() {
     }
   }
 
+  // On an even TORUS or CYLINDER, every neighbor has the other color, so
+  //   graph degrees match neighbor counts, and ids count up row by row
+  mchess_variant_t variants[] = { CYLINDER, TORUS };
+  for (int v = 0; v < 2; v++) {
+    mchess_t *wrapped = mchess_create(N, variants[v]);
+    graph_t *wg = mchess_generate_graph(wrapped);
+    int next_id[2] = { 0, 0 };
+    for (int row = 0; row < N; row++) {
+      for (int col = 0; col < N; col++) {
+        pos.row = row;
+        pos.col = col;
+        int id = mchess_get_tile_id(wrapped, &pos);
+        if (id == -1) {
+          continue;
+        }
+
+        int color = (row + col) % 2;
+        assert(id == next_id[color]++);
+        assert(graph_get_num_neighbors(wg, color, id, 1 - color) ==
+            mchess_get_num_neighbors(wrapped, &pos));
+      }
+    }
+    assert(next_id[0] + next_id[1] == N * N - 2);
+
+    // A full CYLINDER has 2N^2 - N edges and a TORUS 2N^2, and each removed
+    //   square takes 3 (CYLINDER) or 4 (TORUS) with it
+    int edges = 0;
+    for (int i = 0; i < next_id[0]; i++) {
+      edges += graph_get_num_neighbors(wg, 0, i, 1);
+    }
+    assert(edges == ((v == 0) ? 2 * N * N - N - 6 : 2 * N * N - 8));
+    mchess_free(wrapped);
+  }
+
   return 0;
 }
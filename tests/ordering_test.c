@@ -0,0 +1,97 @@
+/** @file ordering_test.c
+ *  @brief Tests the ordering.c file.
+ *
+ *  @author Cayden Codel (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "cnf.h"
+#include "ordering.h"
+
+#define V 40
+
+/** @brief Checks that an order is a permutation of 1..V. */
+static void check_permutation(const int *order) {
+  bool seen[V + 1] = { false };
+  for (int i = 0; i < V; i++) {
+    assert(1 <= order[i] && order[i] <= V);
+    assert(!seen[order[i]]);
+    seen[order[i]] = true;
+  }
+}
+
+int main() {
+  // A chain of binary clauses over a scattered naming of the variables
+  cnf_t *cnf = cnf_create(V);
+  for (int i = 0; i + 1 < V; i++) {
+    int a = (i * 7) % V + 1, b = ((i + 1) * 7) % V + 1;
+    cnf_add_lit(cnf, a);
+    cnf_add_lit(cnf, -b);
+    cnf_add_lit(cnf, 0);
+  }
+
+  int identity[V];
+  for (int i = 0; i < V; i++) {
+    identity[i] = i + 1;
+  }
+  const long long base_cost = ordering_span_cost(cnf, identity);
+
+  // A path is ordered with every clause spanning one position
+  int *rcm = ordering_rcm(cnf);
+  check_permutation(rcm);
+  assert(ordering_span_cost(cnf, rcm) == V - 1);
+
+  // Eliminating a path never needs fill
+  int *mf = ordering_min_fill(cnf);
+  check_permutation(mf);
+
+  // Sifting never makes an order worse
+  long long cost = ordering_sift(cnf, identity, 8, 4);
+  check_permutation(identity);
+  assert(cost == ordering_span_cost(cnf, identity));
+  assert(cost <= base_cost);
+
+  // Along the path, each variable has one later neighbor, its parent
+  int parent[V + 1];
+  assert(ordering_elimination_tree(cnf, rcm, parent) == 1);
+  int roots = 0;
+  for (int i = 0; i < V; i++) {
+    roots += (parent[rcm[i]] == 0);
+  }
+  assert(roots == 1 && parent[rcm[V - 1]] == 0);
+  assert(parent[rcm[0]] == rcm[1]);
+
+  // Eliminating the middle of a path first connects its two halves
+  int middle[V];
+  for (int i = 0; i < V; i++) {
+    middle[i] = rcm[(i + V / 2) % V];
+  }
+  assert(ordering_elimination_tree(cnf, middle, parent) == 2);
+
+  // Each clause goes in the bucket of its first eliminated variable
+  int bucket[V - 1];
+  ordering_clause_buckets(cnf, rcm, bucket);
+  for (int c = 0; c < V - 1; c++) {
+    int size;
+    const int *lits = cnf_get_clause(cnf, c, &size);
+    assert(bucket[c] == abs(lits[0]) || bucket[c] == abs(lits[1]));
+    assert(bucket[c] != rcm[V - 1]);
+  }
+
+  // Lists with repeats and missing variables are completed
+  int list[] = { 5, 5, -3, 100 };
+  int *from = ordering_from_list(list, 4, V);
+  check_permutation(from);
+  assert(from[0] == 5 && from[1] == 3 && from[2] == 1);
+
+  free(rcm);
+  free(mf);
+  free(from);
+  cnf_free(cnf);
+  return 0;
+}
@@ -0,0 +1,53 @@
+/** @file perturb_test.c
+ *  @brief Tests the perturb.c file.
+ *
+ *  @author Cayden Codel (ccodel@andrew.cmu.edu)
+ *
+ *  @bug No known bugs.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "perturb.h"
+#include "pigeon.h"
+#include "graph.h"
+
+#define N 6
+
+int main() {
+  pigeon_t *pigeon = pigeon_create(N);
+  graph_t *g = pigeon_generate_graph(pigeon);
+  const int *sizes = graph_get_partition_sizes(g);
+
+  // A complete graph only loses edges, never below the minimum degree
+  perturb_t *p = perturb_create(g, 0, 1, N - 2, 3);
+  assert(perturb_apply(p, 5) == 5);
+  assert(perturb_get_num_flips(p) == 5);
+  int edges = 0;
+  for (int i = 0; i < sizes[0]; i++) {
+    assert(graph_get_num_neighbors(g, 0, i, 1) >= N - 2);
+    edges += graph_get_num_neighbors(g, 0, i, 1);
+  }
+  assert(edges < (N + 1) * N);
+  for (int j = 0; j < sizes[1]; j++) {
+    assert(graph_get_num_neighbors(g, 1, j, 0) >= N - 2);
+  }
+
+  // Undoing restores the base graph
+  perturb_undo(p);
+  assert(perturb_get_num_flips(p) == 0);
+  for (int i = 0; i < sizes[0]; i++) {
+    assert(graph_get_num_neighbors(g, 0, i, 1) == N);
+  }
+
+  // Once every removable edge is gone, flips stop short
+  perturb_t *q = perturb_create(g, 0, 1, N, 3);
+  assert(perturb_apply(q, 1) == 0);
+
+  perturb_free(p);
+  perturb_free(q);
+  graph_free(g);
+  pigeon_free(pigeon);
+  return 0;
+}
@@ -0,0 +1,15 @@
+#!/bin/sh
+# Checks that -R writes the same formulas as one run per seed.
+set -e
+BIN=$(pwd)/bipartgen
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR"
+for args in "-n 5 -E 12 -e sinz" "-n 3 -c 0 -E 12 -e direct" "-n 6 -D 0.3 -e linear -M"; do
+  $BIN -g random $args -R 1:4 -f range > /dev/null
+  for seed in 1 2 3 4; do
+    $BIN -g random $args -s $seed -f single > /dev/null
+    cmp -s rangeS$seed.cnf single.cnf || { echo "-R differs from -s $seed for: $args"; exit 1; }
+  done
+done
+echo "seed range matches single runs"